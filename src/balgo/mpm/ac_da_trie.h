@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 
+#include "balgo/trie/memory_stats.h"
 #include "balgo/trie/trie_traits.h"
 #include "ac_trie.h"
 
@@ -166,7 +167,9 @@ class AcDaTrie : public AcTrie<Char, Value, NodePtr> {
     }
   };
 
-  AcDaTrie() {
+  AcDaTrie()
+      : free_head_(Null()),
+        peak_bytes_(0) {
   }
   virtual ~AcDaTrie() {
   }
@@ -264,6 +267,8 @@ class AcDaTrie : public AcTrie<Char, Value, NodePtr> {
     Unit(Root()).check = Root();
 
     BuildNode(0, Root(), 0, kids_.size());
+    peak_bytes_ = CapacityInBytes(units_) + CapacityInBytes(values_) + CapacityInBytes(kids_)
+        + CapacityInBytes(keys_) + CapacityInBytes(auxes_);
 
     // release auxes_
     KeyContainer().swap(keys_);
@@ -271,6 +276,7 @@ class AcDaTrie : public AcTrie<Char, Value, NodePtr> {
   }
 
   virtual void Clear() {
+    peak_bytes_ = 0;
     units_.clear();
     values_.clear();
     kids_.clear();
@@ -290,6 +296,33 @@ class AcDaTrie : public AcTrie<Char, Value, NodePtr> {
     return "DaTrie";
   }
 
+  virtual MemoryStats MemoryUsage() const {
+    MemoryStats stats;
+    stats.nodes = SizeInBytes(units_);
+    stats.values = SizeInBytes(values_);
+    stats.build = CapacityInBytes(kids_) + CapacityInBytes(keys_) + CapacityInBytes(auxes_);
+    stats.slack = SlackInBytes(units_) + SlackInBytes(values_);
+    stats.peak = peak_bytes_;
+    std::size_t used = 0;
+    for (std::size_t i = Root(); i < units_.size(); ++i) {
+      used += units_[i].check != Null();
+    }
+    if (!units_.empty()) {
+      stats.fill_ratio = static_cast<double>(used) / static_cast<double>(units_.size());
+    }
+    return stats;
+  }
+
+  /// Frees the key ids and unused capacity once built, keeping pending keys
+  virtual void ShrinkToFit() {
+    if (!keys_.empty()) {
+      return;
+    }
+    KidContainer().swap(kids_);
+    NodeContainer(units_).swap(units_);
+    ValueContainer(values_).swap(values_);
+  }
+
   std::string ToString() const {
     std::stringstream ss;
     for (std::size_t i = Root(); i < units_.size(); ++i) {
@@ -438,6 +471,7 @@ class AcDaTrie : public AcTrie<Char, Value, NodePtr> {
   KeyContainer keys_;
   NodePtr free_head_;
   AuxContainer auxes_;
+  std::size_t peak_bytes_;  ///< Peak allocation of the last Build
 };
 
 }  // namespace balgo
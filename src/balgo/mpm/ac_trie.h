@@ -26,6 +26,8 @@
 #ifndef BALGO_AC_AC_TRIE_H_
 #define BALGO_AC_AC_TRIE_H_
 
+#include "balgo/trie/memory_stats.h"
+
 namespace balgo {
 
 /**
@@ -61,6 +63,8 @@ class AcTrie {
   virtual void Insert(const Char* begin, const Char* end, const Value &value) = 0;
   virtual void Build(bool sort = true) = 0;
   virtual void Clear() = 0;
+  virtual MemoryStats MemoryUsage() const = 0;
+  virtual void ShrinkToFit() = 0;
 };
 
 }  // namespace balgo
@@ -27,7 +27,13 @@
 #ifndef BALGO_AC_AHO_CORASICK_H_
 #define BALGO_AC_AHO_CORASICK_H_
 
+#include <algorithm>
 #include <queue>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include "ac_da_trie.h"
 #include "multi_pattern_matcher.h"
@@ -36,18 +42,84 @@ namespace balgo {
 
 /**
  * @brief Aho–Corasick automata
+ *
+ * The scan follows fail links on a mismatch, or with set_dense it takes one
+ * load from a DFA table per input label.
  */
 template<typename Char, typename Value, typename Trie = AcDaTrie<Char, Value> >
 class AhoCorasick : public MultiPatternMatcher<Char, Value> {
  public:
   typedef typename Trie::NodePtrType NodePtr;
+  typedef typename TrieTraits<Char>::UChar UChar;
+  typedef std::vector<NodePtr> StateContainer;
+  typedef typename MultiPatternMatcher<Char, Value>::MatchFunc MatchFunc;
+
+  /**
+   * @brief Where a scan of a stream stopped, for Match over its chunks
+   *
+   * A default state is at the start of a stream. It belongs to the matcher
+   * that scanned with it, and is invalid after that matcher's Clear.
+   */
+  struct MatchState {
+    MatchState()
+        : node(0),
+          offset(0) {
+    }
+    void Reset() {
+      node = 0;
+      offset = 0;
+    }
+    NodePtr node;        ///< Automaton state, 0 at the start of a stream
+    std::size_t offset;  ///< Stream offset of the next label to scan
+  };
+
+  struct MatchHit {
+    Value value;
+    std::size_t offset;  ///< Offset of the last label of the match
+  };
+  typedef std::vector<MatchHit> HitContainer;
 
   AhoCorasick()
-      : not_built_(true) {
+      : not_built_(true),
+        dense_(false),
+        max_length_(0),
+        num_classes_(0),
+        match_start_(0) {
   }
   virtual ~AhoCorasick() {
   }
 
+  /**
+   * Selects the dense DFA for the next Build.
+   * Every fail link is resolved ahead of time into a table with a row per
+   * state and a column per label class, where the labels of no pattern share
+   * class 0 and every other label has a class of its own. Only unused labels
+   * are merged, but no coarser classes exist: a state with a child for label
+   * a steps on a to it, while on any other label it steps to the root or to
+   * a state entered by that label, so no two pattern labels share a column
+   * and the table is as narrow as the distinct labels allow. States that
+   * report come last, so the scan checks for a match with one compare. Only
+   * Chars of up to two bytes are supported, and a table too large for
+   * NodePtr keeps the fail links.
+   */
+  void set_dense(bool dense) {
+    dense_ = dense;
+  }
+
+  bool dense() const {
+    return dense_;
+  }
+
+  /// Whether the last Build made the DFA table
+  bool IsDense() const {
+    return !delta_.empty();
+  }
+
+  /// Columns of the DFA table, 0 if there is none
+  std::size_t NumClasses() const {
+    return num_classes_;
+  }
+
   std::size_t NodeSize() const {
     return trie_.NodeSize();
   }
@@ -56,10 +128,122 @@ class AhoCorasick : public MultiPatternMatcher<Char, Value> {
     return trie_.NumNodes();
   }
 
+  MemoryStats MemoryUsage() const {
+    MemoryStats stats = trie_.MemoryUsage();
+    stats.extra += SizeInBytes(delta_) + SizeInBytes(classes_) + SizeInBytes(reports_);
+    stats.slack += SlackInBytes(delta_) + SlackInBytes(classes_) + SlackInBytes(reports_);
+    stats.peak += CapacityInBytes(delta_) + CapacityInBytes(classes_) + CapacityInBytes(reports_);
+    return stats;
+  }
+
+  void ShrinkToFit() {
+    trie_.ShrinkToFit();
+    StateContainer(delta_).swap(delta_);
+    StateContainer(classes_).swap(classes_);
+    StateContainer(reports_).swap(reports_);
+  }
+
   std::string Name() const {
     return "AhoCorasick";
   }
 
+  using MultiPatternMatcher<Char, Value>::Match;
+
+  /// Same as MultiPatternMatcher::Match with a visitor, inlined into the scan
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  Match(const Char* begin, const Char* end, Visitor&& visit) const {
+    return Scan(begin, end, visit);
+  }
+
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  Match(const Char* begin, std::size_t length, Visitor&& visit) const {
+    return Scan(begin, begin + length, visit);
+  }
+
+  /**
+   * Scans [begin, end) as the chunk of a stream after state, so a match may
+   * span chunks, and visit gets stream offsets. state then points after the
+   * chunk, or after the label of the match where visit stopped the scan;
+   * further matches ending at that label are not visited.
+   * @return the number of matches visited
+   */
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  Match(MatchState* state, const Char* begin, const Char* end, Visitor&& visit) const {
+    return Scan(state, begin, end, visit);
+  }
+
+  std::size_t Match(MatchState* state, const Char* begin, const Char* end,
+                    MatchFunc& func) const {
+    FuncVisitor visit(func);
+    return Scan(state, begin, end, visit);
+  }
+
+  /**
+   * Scans [begin, end) split into a piece per visitor, each on an OpenMP
+   * thread of its own. A piece is scanned from max pattern length - 1
+   * labels before it without visiting, so every match is visited once, by
+   * the visitor of the piece holding its last label. Each visitor gets its
+   * matches in order, so the visitors in turn see them in the serial order;
+   * a visitor that returns false stops the scan of its own piece only.
+   * Without OpenMP the pieces are scanned one after another.
+   * @return the number of matches visited
+   */
+  template<typename Visitor>
+  std::size_t ParallelMatch(const Char* begin, const Char* end,
+                            std::vector<Visitor>* visitors) const {
+    long num_pieces = static_cast<long>(visitors->size());
+    std::size_t length = static_cast<std::size_t>(std::distance(begin, end));
+    std::size_t overlap = max_length_ > 0 ? max_length_ - 1 : 0;
+    std::vector<std::size_t> counts(visitors->size(), 0);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < num_pieces; ++i) {
+      std::size_t idx = static_cast<std::size_t>(i);
+      std::size_t first = length * idx / visitors->size();
+      std::size_t last = length * (idx + 1) / visitors->size();
+      MatchState state;
+      state.offset = first - std::min(overlap, first);
+      Advance(&state, begin + state.offset, begin + first);
+      counts[idx] = Scan(&state, begin + first, begin + last, (*visitors)[idx]);
+    }
+    std::size_t cnt = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+      cnt += counts[i];
+    }
+    return cnt;
+  }
+
+  /**
+   * Appends the matches in [begin, end) to hits in the serial order, with
+   * one piece per thread as above.
+   * @param num_threads 0 for the OpenMP default
+   */
+  std::size_t ParallelMatch(const Char* begin, const Char* end, HitContainer* hits,
+                            int num_threads = 0) const {
+#if defined(_OPENMP)
+    if (num_threads <= 0) {
+      num_threads = omp_get_max_threads();
+    }
+#endif
+    std::vector<HitVisitor> visitors(static_cast<std::size_t>(std::max(num_threads, 1)));
+    std::size_t cnt = ParallelMatch(begin, end, &visitors);
+    hits->reserve(hits->size() + cnt);
+    for (std::size_t i = 0; i < visitors.size(); ++i) {
+      hits->insert(hits->end(), visitors[i].hits.begin(), visitors[i].hits.end());
+      HitContainer().swap(visitors[i].hits);
+    }
+    return cnt;
+  }
+
+  /// Longest pattern inserted
+  std::size_t MaxLength() const {
+    return max_length_;
+  }
+
   std::string ToString() const {
     return trie_.ToString();
   }
@@ -73,21 +257,78 @@ class AhoCorasick : public MultiPatternMatcher<Char, Value> {
 
  protected:
   typedef MultiPatternMatcher<Char, Value> Base;
-  typedef typename Base::MatchFunc MatchFunc;
+  typedef typename Base::FuncVisitor FuncVisitor;
 
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
     trie_.Insert(begin, end, value);
+    max_length_ = std::max(max_length_, static_cast<std::size_t>(std::distance(begin, end)));
   }
 
   virtual void DoBuild(bool sort = true) {
     trie_.Build();
     Compile();
+    if (dense_) {
+      CompileDense();
+    }
   }
 
   virtual std::size_t DoMatch(const Char* begin, const Char* end, MatchFunc& func) const {
+    FuncVisitor visit(func);
+    return Scan(begin, end, visit);
+  }
+
+  void DoClear() {
+    max_length_ = 0;
+    trie_.Clear();
+    ClearDense();
+  }
+
+ private:
+  virtual NodePtr Root() const {
+    return trie_.Root();
+  }
+  virtual NodePtr Child(NodePtr parent, Char label) const {
+    return trie_.Child(parent, label);
+  }
+  virtual bool IsFinal(NodePtr p) const {
+    return trie_.IsFinal(p);
+  }
+  virtual const Value* GetValue(NodePtr p) const {
+    return trie_.GetValue(p);
+  }
+
+  /// Collects the matches of a piece for ParallelMatch
+  struct HitVisitor {
+    bool operator()(const Value& value, std::size_t offset) {
+      MatchHit hit;
+      hit.value = value;
+      hit.offset = offset;
+      hits.push_back(hit);
+      return true;
+    }
+    HitContainer hits;
+  };
+
+  /// Labels a class table covers, 0 if Char is too wide for one
+  static const std::size_t kClassLabels = sizeof(Char) <= 2
+      ? static_cast<std::size_t>(1) << (sizeof(Char) * 8) : 0;
+
+  /// The scan of DoMatch and Match with an inlined visitor
+  template<typename Visitor>
+  std::size_t Scan(const Char* begin, const Char* end, Visitor& visit) const {
+    MatchState state;
+    return Scan(&state, begin, end, visit);
+  }
+
+  template<typename Visitor>
+  std::size_t Scan(MatchState* state, const Char* begin, const Char* end, Visitor& visit) const {
+    if (IsDense()) {
+      return DenseScan(state, begin, end, visit);
+    }
     NodePtr root = trie_.Root();
-    NodePtr cur = trie_.Root();
+    NodePtr cur = state->node == trie_.Null() ? root : state->node;
     NodePtr nxt = trie_.Null();
+    std::size_t offset = state->offset;
     std::size_t cnt = 0;
     for (const Char* it = begin; it != end; ++it) {
       while ((nxt = trie_.Child(cur, *it)) == trie_.Null()) {
@@ -98,37 +339,83 @@ class AhoCorasick : public MultiPatternMatcher<Char, Value> {
       }
       if (nxt != trie_.Null()) {
         cur = nxt;
-        std::size_t pos = static_cast<std::size_t>(std::distance(begin, it));
+        std::size_t pos = offset + static_cast<std::size_t>(std::distance(begin, it));
         NodePtr report = cur;
         do {
           const Value* value = trie_.GetValue(report);
           if (value) {
-            func(*(trie_.GetValue(report)), pos);
             ++cnt;
+            if (!visit(*value, pos)) {
+              state->node = cur;
+              state->offset = pos + 1;
+              return cnt;
+            }
           }
           report = trie_.Report(report);
         } while (report != trie_.Null());
       }
     }
+    state->node = cur;
+    state->offset = offset + static_cast<std::size_t>(std::distance(begin, end));
     return cnt;
   }
 
-  void DoClear() {
-    trie_.Clear();
+  /// Moves state over [begin, end) without visiting its matches
+  void Advance(MatchState* state, const Char* begin, const Char* end) const {
+    if (IsDense()) {
+      NodePtr row = state->node;
+      for (const Char* it = begin; it != end; ++it) {
+        row = delta_[row + classes_[static_cast<UChar>(*it)]];
+      }
+      state->node = row;
+    } else {
+      NodePtr root = trie_.Root();
+      NodePtr cur = state->node == trie_.Null() ? root : state->node;
+      for (const Char* it = begin; it != end; ++it) {
+        NodePtr nxt = trie_.Null();
+        while ((nxt = trie_.Child(cur, *it)) == trie_.Null() && cur != root) {
+          cur = trie_.Fail(cur);
+        }
+        if (nxt != trie_.Null()) {
+          cur = nxt;
+        }
+      }
+      state->node = cur;
+    }
+    state->offset += static_cast<std::size_t>(std::distance(begin, end));
   }
 
- private:
-  virtual NodePtr Root() const {
-    return trie_.Root();
-  }
-  virtual NodePtr Child(NodePtr parent, Char label) const {
-    return trie_.Child(parent, label);
-  }
-  virtual bool IsFinal(NodePtr p) const {
-    return trie_.IsFinal(p);
-  }
-  virtual const Value* GetValue(NodePtr p) const {
-    return trie_.GetValue(p);
+  /// Scan with the DFA table, where a state is the offset of its row
+  template<typename Visitor>
+  std::size_t DenseScan(MatchState* state, const Char* begin, const Char* end,
+                        Visitor& visit) const {
+    const NodePtr* delta = &delta_[0];
+    const NodePtr* classes = &classes_[0];
+    NodePtr row = state->node;
+    std::size_t offset = state->offset;
+    std::size_t cnt = 0;
+    for (const Char* it = begin; it != end; ++it) {
+      row = delta[row + classes[static_cast<UChar>(*it)]];
+      if (row >= match_start_) {
+        std::size_t pos = offset + static_cast<std::size_t>(std::distance(begin, it));
+        NodePtr report = reports_[(row - match_start_) / num_classes_];
+        do {
+          const Value* value = trie_.GetValue(report);
+          if (value) {
+            ++cnt;
+            if (!visit(*value, pos)) {
+              state->node = row;
+              state->offset = pos + 1;
+              return cnt;
+            }
+          }
+          report = trie_.Report(report);
+        } while (report != trie_.Null());
+      }
+    }
+    state->node = row;
+    state->offset = offset + static_cast<std::size_t>(std::distance(begin, end));
+    return cnt;
   }
 
   void Compile() {
@@ -160,6 +447,78 @@ class AhoCorasick : public MultiPatternMatcher<Char, Value> {
     return fail;
   }
 
+  /// Whether reaching node reports a match
+  bool Reports(NodePtr node) const {
+    return node != trie_.Root()
+        && (trie_.GetValue(node) != NULL || trie_.Report(node) != trie_.Null());
+  }
+
+  /// Builds the DFA table from the fail links
+  void CompileDense() {
+    ClearDense();
+    if (kClassLabels == 0) {
+      return;
+    }
+    // nodes in breadth-first order, so a fail link points to an earlier one
+    StateContainer order(1, trie_.Root());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      for (NodePtr child = trie_.FirstChild(order[i]); child; child = trie_.Sibling(child)) {
+        order.push_back(child);
+      }
+    }
+    // the columns of two pattern labels always differ, see set_dense
+    StateContainer classes(kClassLabels, 0);
+    NodePtr num_classes = 1;
+    for (std::size_t i = 1; i < order.size(); ++i) {
+      NodePtr& label_class = classes[static_cast<UChar>(trie_.Label(order[i]))];
+      if (label_class == 0) {
+        label_class = num_classes++;
+      }
+    }
+    if (order.size() > static_cast<NodePtr>(-1) / num_classes) {
+      return;
+    }
+    // row offsets, with the states that report last
+    StateContainer rows(trie_.NumNodes(), 0);
+    NodePtr row = 0;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      if (!Reports(order[i])) {
+        rows[order[i]] = row;
+        row += num_classes;
+      }
+    }
+    match_start_ = row;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      if (Reports(order[i])) {
+        rows[order[i]] = row;
+        row += num_classes;
+        reports_.push_back(order[i]);
+      }
+    }
+    delta_.resize(row, 0);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      NodePtr node = order[i];
+      NodePtr* next = &delta_[rows[node]];
+      if (node != trie_.Root()) {
+        const NodePtr* fail = &delta_[rows[trie_.Fail(node)]];
+        std::copy(fail, fail + num_classes, next);
+      }
+      for (NodePtr child = trie_.FirstChild(node); child; child = trie_.Sibling(child)) {
+        next[classes[static_cast<UChar>(trie_.Label(child))]] = rows[child];
+      }
+    }
+    classes_.swap(classes);
+    num_classes_ = num_classes;
+  }
+
+  void ClearDense() {
+    delta_.clear();
+    classes_.clear();
+    reports_.clear();
+    num_classes_ = 0;
+    match_start_ = 0;
+  }
+
   NodePtr FindReport(NodePtr p) const {
     NodePtr fail = trie_.Fail(p);
     if (trie_.Final(fail)) {
@@ -170,7 +529,14 @@ class AhoCorasick : public MultiPatternMatcher<Char, Value> {
   }
 
   bool not_built_;
+  bool dense_;              ///< Build the DFA table
+  std::size_t max_length_;  ///< Longest pattern, the overlap of ParallelMatch plus one
   Trie trie_;
+  StateContainer delta_;    ///< Row offset of the next state by state and label class
+  StateContainer classes_;  ///< Class of each label
+  StateContainer reports_;  ///< Node of each state that reports, in row order
+  NodePtr num_classes_;
+  NodePtr match_start_;     ///< Offset of the first row that reports
 };
 
 }  // namespace balgo
@@ -23,6 +23,10 @@
  * @date		2013-8-18
  */
 
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <utility>
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -76,4 +80,186 @@ TEST(AhoCorasick, Match2) {
   EXPECT_EQ(expected, values) << "ac.ToString: \n" << ac.ToString();
 }
 
+TEST(AhoCorasick, MatchVisitor) {
+  AhoCorasick<char, size_t> mpm;
+  TestMatchVisitor(mpm);
+}
+
+TEST(AhoCorasick, MemoryUsage) {
+  AhoCorasick<char, size_t> mpm;
+  TestMemoryUsage(mpm);
+}
+
+TEST(AhoCorasick, Dense) {
+  AhoCorasick<char, size_t> mpm;
+  mpm.set_dense(true);
+  TestMatchVisitor(mpm);
+  EXPECT_TRUE(mpm.IsDense());
+  EXPECT_EQ(6U, mpm.NumClasses());  // a to e, and the rest
+
+  std::vector<size_t> expected;
+  expected.push_back(0);
+  expected.push_back(0);
+  expected.push_back(2);
+  expected.push_back(1);
+  expected.push_back(4);
+  expected.push_back(3);
+  std::vector<size_t> values;
+  EXPECT_EQ(6U, mpm.Match("ababcdef", &values));
+  EXPECT_EQ(expected, values);
+
+  AhoCorasick<char, size_t> empty;
+  empty.set_dense(true);
+  empty.Build();
+  EXPECT_TRUE(empty.IsDense());
+  EXPECT_EQ(0U, empty.Match("abc"));
+}
+
+TEST(AhoCorasick, DenseMemoryUsage) {
+  AhoCorasick<char, size_t> mpm;
+  mpm.set_dense(true);
+  TestMemoryUsage(mpm);
+  EXPECT_GT(mpm.MemoryUsage().extra, 0U);
+  mpm.Clear();
+  EXPECT_FALSE(mpm.IsDense());
+}
+
+/// Collects every match as (offset, value)
+struct PairVisitor {
+  bool operator()(const size_t& value, size_t offset) {
+    matches.push_back(std::make_pair(offset, value));
+    return true;
+  }
+  std::vector<std::pair<size_t, size_t> > matches;
+};
+
+TEST(AhoCorasick, DenseRandom) {
+  // patterns over a small alphabet overlap a lot, with long fail chains
+  uint32_t seed = 7;
+  std::vector<std::string> patterns;
+  for (size_t i = 0; i < 300; ++i) {
+    seed = seed * 1103515245 + 12345;
+    std::string pattern(1 + (seed >> 16) % 8, 'a');
+    for (size_t j = 0; j < pattern.size(); ++j) {
+      seed = seed * 1103515245 + 12345;
+      pattern[j] = static_cast<char>('a' + (seed >> 16) % 3);
+    }
+    patterns.push_back(pattern);
+  }
+  std::string text;
+  for (size_t i = 0; i < 5000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    text.push_back(static_cast<char>('a' + (seed >> 16) % 4));
+  }
+  text += std::string(100, 'a') + std::string("\xff\x80", 2);
+  AhoCorasick<char, size_t> sparse;
+  AhoCorasick<char, size_t> dense;
+  dense.set_dense(true);
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    sparse.Insert(patterns[i].c_str(), i);
+    dense.Insert(patterns[i].c_str(), i);
+  }
+  sparse.Build();
+  dense.Build();
+  ASSERT_FALSE(sparse.IsDense());
+  ASSERT_TRUE(dense.IsDense());
+  EXPECT_EQ(4U, dense.NumClasses());
+  PairVisitor sparse_matches;
+  PairVisitor dense_matches;
+  size_t cnt = sparse.Match(text.data(), text.size(), sparse_matches);
+  EXPECT_GT(cnt, text.size());
+  EXPECT_EQ(cnt, dense.Match(text.data(), text.size(), dense_matches));
+  EXPECT_EQ(sparse_matches.matches, dense_matches.matches);
+}
+
+TEST(AhoCorasick, Stream) {
+  const char * kPatterns[] = { "a", "bc", "abc", "abcde", "cd", "dea" };
+  size_t n = sizeof(kPatterns) / sizeof(kPatterns[0]);
+  std::string text = "ababcdeabcdeaxabcd";
+  for (int dense = 0; dense < 2; ++dense) {
+    AhoCorasick<char, size_t> ac;
+    ac.set_dense(dense != 0);
+    for (size_t i = 0; i < n; ++i) {
+      ac.Insert(kPatterns[i], i);
+    }
+    ac.Build();
+    PairVisitor whole;
+    size_t cnt = ac.Match(text.data(), text.size(), whole);
+    for (size_t chunk = 1; chunk <= text.size(); ++chunk) {
+      AhoCorasick<char, size_t>::MatchState state;
+      PairVisitor chunks;
+      size_t chunks_cnt = 0;
+      for (size_t begin = 0; begin < text.size(); begin += chunk) {
+        size_t end = std::min(begin + chunk, text.size());
+        chunks_cnt += ac.Match(&state, text.data() + begin, text.data() + end, chunks);
+        EXPECT_EQ(end, state.offset);
+      }
+      EXPECT_EQ(cnt, chunks_cnt) << " chunk: " << chunk;
+      EXPECT_EQ(whole.matches, chunks.matches) << " chunk: " << chunk;
+    }
+
+    // a stopped scan resumes after the label of its last match
+    AhoCorasick<char, size_t>::MatchState state;
+    CollectVisitor first(1);
+    EXPECT_EQ(1U, ac.Match(&state, text.data(), text.data() + text.size(), first));
+    EXPECT_EQ(whole.matches[0].first + 1, state.offset);
+    FirstMatchFunc func;
+    EXPECT_EQ(1U, ac.Match(&state, text.data() + state.offset, text.data() + text.size(), func));
+    EXPECT_EQ(1U, func.cnt);
+    EXPECT_EQ(whole.matches[1].first + 1, state.offset);
+    state.Reset();
+    EXPECT_EQ(0U, ac.Match(&state, text.data() + 1, text.data() + 2, first));
+    EXPECT_EQ(1U, state.offset);
+  }
+}
+
+TEST(AhoCorasick, ParallelMatch) {
+  uint32_t seed = 11;
+  std::string text;
+  for (size_t i = 0; i < 3000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    text.push_back(static_cast<char>('a' + (seed >> 16) % 3));
+  }
+  const char * kPatterns[] = { "a", "abc", "bcab", "cc", "abcabcab", "baab" };
+  size_t n = sizeof(kPatterns) / sizeof(kPatterns[0]);
+  for (int dense = 0; dense < 2; ++dense) {
+    AhoCorasick<char, size_t> ac;
+    ac.set_dense(dense != 0);
+    for (size_t i = 0; i < n; ++i) {
+      ac.Insert(kPatterns[i], i);
+    }
+    ac.Build();
+    EXPECT_EQ(8U, ac.MaxLength());
+    // pieces of all sizes, down to shorter than the overlap
+    for (size_t length = 0; length <= text.size(); length = length * 3 + 1) {
+      PairVisitor serial;
+      size_t cnt = ac.Match(text.data(), length, serial);
+      for (int threads = 1; threads <= 8; ++threads) {
+        AhoCorasick<char, size_t>::HitContainer hits;
+        EXPECT_EQ(cnt, ac.ParallelMatch(text.data(), text.data() + length, &hits, threads));
+        std::vector<std::pair<size_t, size_t> > matches;
+        for (size_t i = 0; i < hits.size(); ++i) {
+          matches.push_back(std::make_pair(hits[i].offset, hits[i].value));
+        }
+        EXPECT_EQ(serial.matches, matches) << " length: " << length << " threads: " << threads;
+      }
+    }
+
+    std::vector<PairVisitor> sinks(5);
+    PairVisitor serial;
+    size_t cnt = ac.Match(text.data(), text.size(), serial);
+    EXPECT_EQ(cnt, ac.ParallelMatch(text.data(), text.data() + text.size(), &sinks));
+    std::vector<std::pair<size_t, size_t> > matches;
+    for (size_t i = 0; i < sinks.size(); ++i) {
+      EXPECT_FALSE(sinks[i].matches.empty());
+      matches.insert(matches.end(), sinks[i].matches.begin(), sinks[i].matches.end());
+    }
+    EXPECT_EQ(serial.matches, matches);
+
+    // a stop ends the piece of its visitor only
+    std::vector<CollectVisitor> firsts(3, CollectVisitor(1));
+    EXPECT_EQ(3U, ac.ParallelMatch(text.data(), text.data() + text.size(), &firsts));
+  }
+}
+
 }  // namespace balgo
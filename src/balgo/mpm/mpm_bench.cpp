@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-17
+ */
+
+/**
+ * @brief Benchmarks of the multi-pattern matchers
+ *
+ * Usage: mpm_bench [num_patterns ...]
+ */
+
+#include <stdint.h>
+#include <omp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+#include "aho_corasick.h"
+
+namespace {
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+uint64_t NextRandom(uint64_t* seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+/// Dictionary-like patterns: 3-16 lowercase letters, generated as the keys of trie_bench
+std::vector<std::string> GenerateKeys(std::size_t n) {
+  std::vector<std::string> keys(n);
+  uint64_t seed = 88172645463325252ULL;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t length = 3 + static_cast<std::size_t>(NextRandom(&seed) % 14);
+    for (std::size_t j = 0; j < length; ++j) {
+      uint64_t r = NextRandom(&seed) % 26;
+      r = r * r / 26;
+      keys[i].push_back(static_cast<char>('a' + r));
+    }
+  }
+  return keys;
+}
+
+/// Counts the matches of an AhoCorasick scan
+struct CountVisitor {
+  CountVisitor() : cnt(0) { }
+  bool operator()(const uint32_t& /*value*/, std::size_t /*offset*/) {
+    ++cnt;
+    return true;
+  }
+  std::size_t cnt;
+};
+
+/// Scans text made of the key letters, and a run of one letter, with and without the DFA table
+void BenchAhoCorasick(std::size_t num_patterns) {
+  const std::size_t kTextBytes = 16 << 20;
+  std::vector<std::string> keys = GenerateKeys(num_patterns);
+  std::string texts[2];
+  uint64_t seed = 521288629ULL;
+  for (std::size_t i = 0; i < kTextBytes; ++i) {
+    uint64_t r = NextRandom(&seed) % 26;
+    texts[0].push_back(static_cast<char>('a' + r * r / 26));
+  }
+  texts[1].assign(kTextBytes, 'a');
+  const char* kTextNames[] = { "letters", "run" };
+  for (int dense = 0; dense < 2; ++dense) {
+    balgo::AhoCorasick<char, uint32_t> ac;
+    ac.set_dense(dense != 0);
+    double start = Now();
+    for (std::size_t i = 0; i < num_patterns; ++i) {
+      ac.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+    }
+    ac.Build();
+    ac.ShrinkToFit();
+    double build = Now() - start;
+    balgo::MemoryStats stats = ac.MemoryUsage();
+    for (int t = 0; t < 2; ++t) {
+      CountVisitor visit;
+      start = Now();
+      ac.Match(texts[t].data(), texts[t].size(), visit);
+      double elapsed = Now() - start;
+      std::cout << "[AhoCorasick] " << (ac.IsDense() ? "dense" : "fail links") << " patterns="
+          << num_patterns << ", classes=" << ac.NumClasses() << ", build=" << build
+          << "s, MB=" << static_cast<double>(stats.Total()) / 1e6 << ", text="
+          << kTextNames[t] << ", matches=" << visit.cnt << ", MB/s="
+          << static_cast<double>(kTextBytes) / 1e6 / elapsed << std::endl;
+    }
+    // the letters again, as a stream of packet-sized chunks
+    const std::size_t kChunk = 1500;
+    balgo::AhoCorasick<char, uint32_t>::MatchState state;
+    CountVisitor visit;
+    start = Now();
+    for (std::size_t begin = 0; begin < kTextBytes; begin += kChunk) {
+      std::size_t end = std::min(begin + kChunk, kTextBytes);
+      ac.Match(&state, texts[0].data() + begin, texts[0].data() + end, visit);
+    }
+    double elapsed = Now() - start;
+    std::cout << "[AhoCorasick] " << (ac.IsDense() ? "dense" : "fail links") << " patterns="
+        << num_patterns << ", text=" << kTextNames[0] << " in " << kChunk << "B chunks, matches="
+        << visit.cnt << ", MB/s=" << static_cast<double>(kTextBytes) / 1e6 / elapsed << std::endl;
+    // and split across threads, with the hits gathered in order
+    int threads[] = { 1, omp_get_max_threads() };
+    for (int t = 0; t < 2; ++t) {
+      balgo::AhoCorasick<char, uint32_t>::HitContainer hits;
+      start = Now();
+      ac.ParallelMatch(texts[0].data(), texts[0].data() + kTextBytes, &hits, threads[t]);
+      elapsed = Now() - start;
+      std::cout << "[AhoCorasick] " << (ac.IsDense() ? "dense" : "fail links") << " patterns="
+          << num_patterns << ", text=" << kTextNames[0] << " on " << threads[t]
+          << " threads, matches=" << hits.size() << ", MB/s="
+          << static_cast<double>(kTextBytes) / 1e6 / elapsed << std::endl;
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(static_cast<std::size_t>(std::atol(argv[i])));
+  }
+  if (sizes.empty()) {
+    sizes.push_back(100);
+    sizes.push_back(10000);
+  }
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    BenchAhoCorasick(sizes[i]);
+  }
+  return 0;
+}
@@ -23,6 +23,8 @@
  * @date		2013-8-18
  */
 
+#include <algorithm>
+#include <string>
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -48,4 +50,81 @@ static void TestMatch(MultiPatternMatcher<char, size_t>& mpm) {
   EXPECT_EQ(6U, mpm.Match("ababcdef"));
 }
 
+/// Collects the matches passed to it, up to a limit
+struct CollectVisitor {
+  explicit CollectVisitor(size_t l) : limit(l) { }
+  bool operator()(const size_t& value, size_t offset) {
+    values.push_back(value);
+    offsets.push_back(offset);
+    return values.size() < limit;
+  }
+  size_t limit;
+  std::vector<size_t> values;
+  std::vector<size_t> offsets;
+};
+
+/// Stops the scan at the first match
+struct FirstMatchFunc : public MultiPatternMatcher<char, size_t>::MatchFunc {
+  FirstMatchFunc() : cnt(0) { }
+  virtual void operator()(const size_t& /*value*/, std::size_t /*offset*/) {
+    ++cnt;
+    stop = true;
+  }
+  size_t cnt;
+};
+
+/// Checks the visitor overloads of the concrete matcher and of its base
+template<typename Mpm>
+static void TestMatchVisitor(Mpm& mpm) {
+  TestMatch(mpm);
+  const MultiPatternMatcher<char, size_t>& base = mpm;
+  std::string text = "ababcdef";
+  std::vector<size_t> values;
+  ASSERT_EQ(6U, mpm.Match(text.c_str(), &values));
+
+  CollectVisitor all(100);
+  EXPECT_EQ(6U, mpm.Match(text.data(), text.size(), all));
+  std::vector<size_t> sorted(all.values);
+  std::vector<size_t> expected(values);
+  std::sort(sorted.begin(), sorted.end());
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, sorted);
+  CollectVisitor base_all(100);
+  EXPECT_EQ(6U, base.Match(text.data(), text.data() + text.size(), base_all));
+  EXPECT_EQ(all.values, base_all.values);
+  EXPECT_EQ(all.offsets, base_all.offsets);
+
+  for (size_t limit = 1; limit <= 6; ++limit) {
+    CollectVisitor some(limit);
+    EXPECT_EQ(limit, mpm.Match(text.data(), text.size(), some));
+    CollectVisitor base_some(limit);
+    EXPECT_EQ(limit, base.Match(text.data(), text.size(), base_some));
+    std::vector<size_t> head(all.values);
+    head.resize(limit);
+    EXPECT_EQ(head, some.values);
+    EXPECT_EQ(some.values, base_some.values);
+  }
+
+  FirstMatchFunc first;
+  EXPECT_EQ(1U, mpm.Match(text.data(), text.data() + text.size(), first));
+  EXPECT_EQ(1U, first.cnt);
+}
+
+static void TestMemoryUsage(MultiPatternMatcher<char, size_t>& mpm) {
+  TestMatch(mpm);
+  MemoryStats stats = mpm.MemoryUsage();
+  EXPECT_EQ(mpm.NodeSize() * mpm.NumNodes(), stats.nodes);
+  EXPECT_EQ(5 * sizeof(size_t), stats.values);
+  EXPECT_GE(stats.peak, stats.nodes + stats.values);
+  EXPECT_GT(stats.fill_ratio, 0);
+  EXPECT_LE(stats.fill_ratio, 1);
+
+  mpm.ShrinkToFit();
+  stats = mpm.MemoryUsage();
+  EXPECT_EQ(0U, stats.build);
+  EXPECT_EQ(0U, stats.slack);
+  EXPECT_EQ(stats.nodes + stats.values + stats.extra, stats.Total());
+  EXPECT_EQ(6U, mpm.Match("ababcdef"));
+}
+
 }  // namespace balgo
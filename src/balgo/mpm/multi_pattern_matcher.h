@@ -30,6 +30,9 @@
 #include <sstream>
 #include <string>
 
+#include "balgo/trie/memory_stats.h"
+#include "balgo/trie/trie_traits.h"
+
 namespace balgo {
 
 /**
@@ -39,8 +42,10 @@ template<typename Char, typename Value>
 class MultiPatternMatcher {
  public:
   struct MatchFunc {
+    MatchFunc() : stop(false) { }
     virtual void operator()(const Value& value, std::size_t offset) {
     }
+    bool stop;  ///< Set by operator() to end the scan after this match
   };
 
   template<typename Values>
@@ -90,6 +95,26 @@ class MultiPatternMatcher {
     return DoMatch(begin, end, func);
   }
 
+  /**
+   * Calls visit(value, offset) for each match in [begin, end), where offset
+   * is that of its last character; visit returns false to stop the scan.
+   * Here it is called through DoMatch; AhoCorasick and TrieMpm overload this
+   * to inline visit into their scan loops.
+   * @return the number of matches visited
+   */
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  Match(const Char* begin, const Char* end, Visitor&& visit) const {
+    VisitorMatchFunc<typename std::remove_reference<Visitor>::type> func(visit);
+    return DoMatch(begin, end, func);
+  }
+
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  Match(const Char* begin, std::size_t length, Visitor&& visit) const {
+    return Match(begin, begin + length, visit);
+  }
+
   template<typename Values>
   std::size_t Match(const Char* begin, const Char* end, Values* values, bool clear = true) const {
     if (values && clear) values->clear();
@@ -97,8 +122,8 @@ class MultiPatternMatcher {
       ValueMatchFunc<Values> func(values);
       return DoMatch(begin, end, func);
     } else {
-      static MatchFunc s_func;
-      return DoMatch(begin, end, s_func);
+      MatchFunc func;
+      return DoMatch(begin, end, func);
     }
   }
 
@@ -114,8 +139,8 @@ class MultiPatternMatcher {
   }
 
   std::size_t Match(const Char* begin, const Char* end) const {
-    static MatchFunc s_func;
-    return DoMatch(begin, end, s_func);
+    MatchFunc func;
+    return DoMatch(begin, end, func);
   }
 
   std::size_t Match(const Char* begin, std::size_t length) const {
@@ -135,6 +160,12 @@ class MultiPatternMatcher {
   virtual std::size_t NodeSize() const = 0;
   virtual std::size_t NumNodes() const = 0;
 
+  /// Returns the memory held by this matcher, component by component
+  virtual MemoryStats MemoryUsage() const = 0;
+
+  /// Frees the build-only structures and unused capacity of a built matcher
+  virtual void ShrinkToFit() = 0;
+
   virtual std::string Name() const {
     return "MultiPatternMatcher";
   }
@@ -151,6 +182,29 @@ class MultiPatternMatcher {
   }
 
  protected:
+  /// Adapts a visitor to a MatchFunc
+  template<typename Visitor>
+  struct VisitorMatchFunc : public MatchFunc {
+    explicit VisitorMatchFunc(Visitor& visit) : visit_(visit) { }
+    virtual void operator()(const Value& value, std::size_t offset) {
+      this->stop = !visit_(value, offset);
+    }
+   private:
+    Visitor& visit_;
+  };
+
+  /// Adapts a MatchFunc to a visitor, for DoMatch of the inlined matchers
+  class FuncVisitor {
+   public:
+    explicit FuncVisitor(MatchFunc& func) : func_(func) { }
+    bool operator()(const Value& value, std::size_t offset) const {
+      func_(value, offset);
+      return !func_.stop;
+    }
+   private:
+    MatchFunc& func_;
+  };
+
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) = 0;
   virtual void DoBuild(bool sort = true) = 0;
   virtual std::size_t DoMatch(const Char* begin, const Char* end, MatchFunc& func) const = 0;
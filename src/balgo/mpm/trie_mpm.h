@@ -27,6 +27,7 @@
 #define BALGO_MPM_TRIE_MPM_H_
 
 #include "balgo/trie/da_trie.h"
+#include "balgo/trie/static_trie.h"
 #include "multi_pattern_matcher.h"
 
 namespace balgo {
@@ -47,10 +48,35 @@ class TrieMpm : public MultiPatternMatcher<Char, Value> {
     return trie_.NumNodes();
   }
 
+  virtual MemoryStats MemoryUsage() const {
+    return trie_.MemoryUsage();
+  }
+
+  virtual void ShrinkToFit() {
+    trie_.ShrinkToFit();
+  }
+
   virtual std::string Name() const {
     return "TrieMpm";
   }
 
+  using MultiPatternMatcher<Char, Value>::Match;
+
+  /// Same as MultiPatternMatcher::Match with a visitor, inlined into the scan
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, typename MultiPatternMatcher<Char, Value>::MatchFunc,
+                           std::size_t>::type
+  Match(const Char* begin, const Char* end, Visitor&& visit) const {
+    return Scan(begin, end, visit);
+  }
+
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, typename MultiPatternMatcher<Char, Value>::MatchFunc,
+                           std::size_t>::type
+  Match(const Char* begin, std::size_t length, Visitor&& visit) const {
+    return Scan(begin, begin + length, visit);
+  }
+
   virtual std::string ToString() const {
     return trie_.ToString();
   }
@@ -59,15 +85,7 @@ class TrieMpm : public MultiPatternMatcher<Char, Value> {
   typedef MultiPatternMatcher<Char, Value> Base;
   typedef typename Base::MatchFunc MatchFunc;
 
-  struct TrieMatchFunc : public Trie::MatchFunc {
-    TrieMatchFunc(MatchFunc& func, std::size_t base) : func_(func), base_(base) { }
-    virtual void operator()(const Value& value, std::size_t offset) {
-      func_(value, base_ + offset);
-    }
-   private:
-    MatchFunc& func_;
-    std::size_t base_;
-  };
+  typedef typename Base::FuncVisitor FuncVisitor;
 
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
    trie_.Insert(begin, end, value);
@@ -78,12 +96,8 @@ class TrieMpm : public MultiPatternMatcher<Char, Value> {
   }
 
   virtual std::size_t DoMatch(const Char* begin, const Char* end, MatchFunc& func) const {
-    std::size_t cnt = 0;
-    for (std::size_t base = 0; begin != end; ++begin, ++base) {
-      TrieMatchFunc tfunc(func, base);
-      cnt += trie_.MatchPrefix(begin, end, tfunc);
-    }
-    return cnt;
+    FuncVisitor visit(func);
+    return Scan(begin, end, visit);
   }
 
   virtual void DoClear() {
@@ -91,6 +105,35 @@ class TrieMpm : public MultiPatternMatcher<Char, Value> {
   }
 
  private:
+  /// Shifts the offsets of the prefix matches at one start of the text
+  template<typename Visitor>
+  class StartVisitor {
+   public:
+    StartVisitor(Visitor& visit, std::size_t start, bool* stop)
+        : visit_(visit), start_(start), stop_(stop) {
+    }
+    bool operator()(const Value& value, std::size_t offset) const {
+      *stop_ = !visit_(value, start_ + offset);
+      return !*stop_;
+    }
+   private:
+    Visitor& visit_;
+    std::size_t start_;
+    bool* stop_;
+  };
+
+  /// The scan of DoMatch and Match with an inlined visitor
+  template<typename Visitor>
+  std::size_t Scan(const Char* begin, const Char* end, Visitor& visit) const {
+    StaticTrie<Trie> trie(trie_);
+    std::size_t cnt = 0;
+    bool stop = false;
+    for (std::size_t start = 0; begin != end && !stop; ++begin, ++start) {
+      cnt += trie.MatchPrefix(begin, end, StartVisitor<Visitor>(visit, start, &stop));
+    }
+    return cnt;
+  }
+
   Trie trie_;
 };
 
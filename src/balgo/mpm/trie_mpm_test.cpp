@@ -46,4 +46,14 @@ TEST(TrieMpm, Match) {
   EXPECT_EQ(expected, values) << "mpm.ToString: \n" << mpm.ToString();
 }
 
+TEST(TrieMpm, MatchVisitor) {
+  TrieMpm<char, size_t> mpm;
+  TestMatchVisitor(mpm);
+}
+
+TEST(TrieMpm, MemoryUsage) {
+  TrieMpm<char, size_t> mpm;
+  TestMemoryUsage(mpm);
+}
+
 }  // namespace balgo
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_ALPHABET_H_
+#define BALGO_TRIE_ALPHABET_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "trie_traits.h"
+
+namespace balgo {
+
+/**
+ * @brief Dense codes for the labels that occur in a trie
+ *
+ * NullChar gets code 0 and the other labels get 1, 2, ... by descending
+ * frequency, so that frequent labels have small codes and a double-array
+ * spends no units on labels that never occur. Lookups go through a two-level
+ * table split at half the bits of UChar; pages without any label share the
+ * first page, so the table of a wide Char holds only the pages in use.
+ *
+ * @note Usage:
+ * 1) Count every label, then Assign; or Assign the labels in code order
+ * 2) Code and Label, and Add for a label seen after Assign
+ */
+template<typename Char>
+class Alphabet {
+ public:
+  typedef typename TrieTraits<Char>::UChar UChar;
+  typedef std::vector<UChar> LabelContainer;
+
+  /// The code of a label that does not occur, which is never a child offset
+  static uint32_t Absent() {
+    return 0xFFFFFFFFU;
+  }
+
+  bool empty() const {
+    return labels_.empty();
+  }
+
+  /// Number of codes, including that of NullChar
+  std::size_t size() const {
+    return labels_.size();
+  }
+
+  /// The labels in code order
+  const LabelContainer& labels() const {
+    return labels_;
+  }
+
+  void Clear() {
+    LabelContainer().swap(labels_);
+    std::vector<uint32_t>().swap(pages_);
+    std::vector<uint32_t>().swap(codes_);
+    std::vector<uint32_t>().swap(ranks_);
+    std::vector<std::vector<std::size_t> >().swap(counts_);
+  }
+
+  /// Counts one occurrence of label, before Assign
+  void Count(Char label) {
+    UChar c = static_cast<UChar>(label);
+    if (counts_.empty()) {
+      counts_.resize(kNumPages);
+    }
+    std::vector<std::size_t>& page = counts_[PageOf(c)];
+    if (page.empty()) {
+      page.resize(kPageSize);
+    }
+    ++page[SlotOf(c)];
+  }
+
+  /// Assigns the codes to the counted labels by descending count
+  void Assign() {
+    std::vector<std::pair<std::size_t, UChar> > ranked;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      for (std::size_t j = 0; j < counts_[i].size(); ++j) {
+        UChar c = static_cast<UChar>((i << kPageBits) | j);
+        if (counts_[i][j] && c != 0) {
+          // negated counts sort the frequent labels first, ties by label
+          ranked.push_back(std::make_pair(~counts_[i][j], c));
+        }
+      }
+    }
+    std::sort(ranked.begin(), ranked.end());
+    LabelContainer labels(1, 0);
+    for (std::size_t i = 0; i < ranked.size(); ++i) {
+      labels.push_back(ranked[i].second);
+    }
+    Assign(labels.begin(), labels.end());
+  }
+
+  /// Assigns code i to the i-th label of [first, last), where the first is NullChar
+  template<typename Iterator>
+  void Assign(Iterator first, Iterator last) {
+    Clear();
+    pages_.assign(kNumPages, 0);
+    codes_.assign(kPageSize, Absent());
+    for (; first != last; ++first) {
+      Add(static_cast<Char>(*first));
+    }
+  }
+
+  /// Returns the code of label, giving it the next code if it has none
+  uint32_t Add(Char label) {
+    uint32_t code = Code(label);
+    if (code != Absent()) {
+      return code;
+    }
+    UChar c = static_cast<UChar>(label);
+    uint32_t& page = pages_[PageOf(c)];
+    if (page == 0) {
+      page = static_cast<uint32_t>(codes_.size());
+      codes_.resize(codes_.size() + kPageSize, Absent());
+    }
+    code = static_cast<uint32_t>(labels_.size());
+    codes_[page + SlotOf(c)] = code;
+    labels_.push_back(c);
+    ranks_.insert(std::upper_bound(ranks_.begin(), ranks_.end(), c, RankLess(labels_)), code);
+    return code;
+  }
+
+  uint32_t Code(Char label) const {
+    UChar c = static_cast<UChar>(label);
+    return codes_[pages_[PageOf(c)] + SlotOf(c)];
+  }
+
+  Char Label(uint32_t code) const {
+    return static_cast<Char>(labels_[code]);
+  }
+
+  /// The code of the rank-th smallest label
+  uint32_t CodeOfRank(std::size_t rank) const {
+    return ranks_[rank];
+  }
+
+  std::size_t MemoryBytes() const {
+    return labels_.capacity() * sizeof(UChar) + (pages_.capacity() + codes_.capacity()
+        + ranks_.capacity()) * sizeof(uint32_t);
+  }
+
+ private:
+  enum {
+    kPageBits = sizeof(UChar) * 4,
+    kPageSize = 1 << kPageBits,
+    kPageMask = kPageSize - 1,
+    kNumPages = 1 << (sizeof(UChar) * 8 - kPageBits)
+  };
+
+  static std::size_t PageOf(UChar c) {
+    return static_cast<std::size_t>(c) >> kPageBits;
+  }
+
+  static std::size_t SlotOf(UChar c) {
+    return static_cast<std::size_t>(c) & kPageMask;
+  }
+
+  /// Orders codes by their labels, comparing a label to a code
+  struct RankLess {
+    explicit RankLess(const LabelContainer& labels) : labels_(labels) { }
+    bool operator()(UChar label, uint32_t code) const {
+      return label < labels_[code];
+    }
+    const LabelContainer& labels_;
+  };
+
+  LabelContainer labels_;           ///< Label of each code
+  std::vector<uint32_t> pages_;     ///< Offset in codes_ of the page of each high half
+  std::vector<uint32_t> codes_;     ///< Pages of codes, the first of which is empty
+  std::vector<uint32_t> ranks_;     ///< Codes in the order of their labels
+  std::vector<std::vector<std::size_t> > counts_;  ///< Pages of label counts
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_ALPHABET_H_
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <string>
+#include <gtest/gtest.h>
+
+#include "alphabet.h"
+
+namespace balgo {
+
+TEST(Alphabet, Assign) {
+  Alphabet<char> alphabet;
+  EXPECT_TRUE(alphabet.empty());
+  std::string text = "banana band";
+  for (size_t i = 0; i < text.size(); ++i) {
+    alphabet.Count(text[i]);
+  }
+  alphabet.Assign();
+  ASSERT_EQ(6U, alphabet.size());
+  // NullChar, then by descending count and ties by label
+  EXPECT_EQ(0U, alphabet.Code('\0'));
+  EXPECT_EQ(1U, alphabet.Code('a'));
+  EXPECT_EQ(2U, alphabet.Code('n'));
+  EXPECT_EQ(3U, alphabet.Code('b'));
+  EXPECT_EQ(4U, alphabet.Code(' '));
+  EXPECT_EQ(5U, alphabet.Code('d'));
+  EXPECT_EQ(Alphabet<char>::Absent(), alphabet.Code('z'));
+  EXPECT_EQ(Alphabet<char>::Absent(), alphabet.Code('\xff'));
+  for (uint32_t code = 0; code < alphabet.size(); ++code) {
+    EXPECT_EQ(code, alphabet.Code(alphabet.Label(code)));
+  }
+  // ranks follow the unsigned labels
+  const char kOrder[] = { '\0', ' ', 'a', 'b', 'd', 'n' };
+  for (size_t rank = 0; rank < alphabet.size(); ++rank) {
+    EXPECT_EQ(kOrder[rank], alphabet.Label(alphabet.CodeOfRank(rank)));
+  }
+
+  EXPECT_EQ(6U, alphabet.Add('\xff'));
+  EXPECT_EQ(6U, alphabet.Add('\xff'));
+  EXPECT_EQ(7U, alphabet.Add('c'));
+  EXPECT_EQ(6U, alphabet.Code('\xff'));
+  EXPECT_EQ(7U, alphabet.CodeOfRank(4));
+  EXPECT_EQ(6U, alphabet.CodeOfRank(7));
+
+  Alphabet<char> copy;
+  copy.Assign(alphabet.labels().begin(), alphabet.labels().end());
+  EXPECT_EQ(alphabet.labels(), copy.labels());
+  EXPECT_EQ(7U, copy.Code('c'));
+}
+
+TEST(Alphabet, Wide) {
+  Alphabet<char32_t> alphabet;
+  alphabet.Count(U'中');
+  alphabet.Count(U'文');
+  alphabet.Count(U'文');
+  alphabet.Count(static_cast<char32_t>(0x1F600));
+  alphabet.Assign();
+  ASSERT_EQ(4U, alphabet.size());
+  EXPECT_EQ(1U, alphabet.Code(U'文'));
+  EXPECT_EQ(2U, alphabet.Code(U'中'));
+  EXPECT_EQ(3U, alphabet.Code(static_cast<char32_t>(0x1F600)));
+  EXPECT_EQ(Alphabet<char32_t>::Absent(), alphabet.Code(U'丮'));
+  EXPECT_EQ(Alphabet<char32_t>::Absent(), alphabet.Code(static_cast<char32_t>(0xFFFFFFFF)));
+  // the page table and the pages of codes: empty, CJK and emoji
+  EXPECT_LE(alphabet.MemoryBytes(), 6U * 65536 * 4);
+}
+
+}  // namespace balgo
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_BIT_VECTOR_H_
+#define BALGO_TRIE_BIT_VECTOR_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace balgo {
+
+/**
+ * @brief Bit vector with rank and select over its zeros
+ *
+ * Rank1 reads one count per 512-bit block plus the words of that block;
+ * Select0 starts from the block of one sampled zero out of 512 and walks the
+ * block counts. The counts take 12.5% of the bits and the samples about 6%
+ * of the zeros.
+ *
+ * @note Usage:
+ * 1) PushBack the bits, then Build
+ * 2) Get, Rank1, Select0 and OnesFrom
+ */
+class BitVector {
+ public:
+  BitVector() : size_(0), num_ones_(0) { }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  std::size_t num_ones() const {
+    return num_ones_;
+  }
+
+  std::size_t num_zeros() const {
+    return size_ - num_ones_;
+  }
+
+  void Clear() {
+    size_ = 0;
+    num_ones_ = 0;
+    std::vector<uint64_t>().swap(words_);
+    std::vector<std::size_t>().swap(ranks_);
+    std::vector<uint32_t>().swap(zero_samples_);
+  }
+
+  void PushBack(bool bit) {
+    if (size_ % kWordBits == 0) {
+      words_.push_back(0);
+    }
+    if (bit) {
+      words_.back() |= uint64_t(1) << (size_ % kWordBits);
+    }
+    ++size_;
+  }
+
+  /// Builds the rank and select directories after the last PushBack
+  void Build() {
+    std::size_t num_blocks = (size_ + kBlockBits - 1) / kBlockBits;
+    // a whole last block and a sentinel count keep the loops simple
+    words_.resize(num_blocks * kBlockWords + kBlockWords, 0);
+    ranks_.assign(num_blocks + 1, 0);
+    zero_samples_.clear();
+    std::size_t ones = 0;
+    std::size_t zeros = 0;
+    for (std::size_t b = 0; b < num_blocks; ++b) {
+      ranks_[b] = ones;
+      std::size_t bits = size_ - b * kBlockBits;
+      std::size_t block_ones = 0;
+      for (std::size_t w = b * kBlockWords; w < (b + 1) * kBlockWords; ++w) {
+        block_ones += PopCount(words_[w]);
+      }
+      zeros += (bits < kBlockBits ? bits : kBlockBits) - block_ones;
+      while (zero_samples_.size() * kSampleRate < zeros) {
+        zero_samples_.push_back(static_cast<uint32_t>(b));
+      }
+      ones += block_ones;
+    }
+    ranks_[num_blocks] = ones;
+    num_ones_ = ones;
+  }
+
+  bool Get(std::size_t pos) const {
+    return (words_[pos / kWordBits] >> (pos % kWordBits)) & 1;
+  }
+
+  /// Number of ones in [0, pos)
+  std::size_t Rank1(std::size_t pos) const {
+    std::size_t block = pos / kBlockBits;
+    std::size_t rank = ranks_[block];
+    std::size_t w = block * kBlockWords;
+    for (; w < pos / kWordBits; ++w) {
+      rank += PopCount(words_[w]);
+    }
+    if (pos % kWordBits) {
+      rank += PopCount(words_[w] & ((uint64_t(1) << (pos % kWordBits)) - 1));
+    }
+    return rank;
+  }
+
+  /// Position of the zero with k zeros before it, k < num_zeros()
+  std::size_t Select0(std::size_t k) const {
+    std::size_t block = zero_samples_[k / kSampleRate];
+    while ((block + 1) * kBlockBits - ranks_[block + 1] <= k) {
+      ++block;
+    }
+    k -= block * kBlockBits - ranks_[block];
+    std::size_t w = block * kBlockWords;
+    for (;; ++w) {
+      std::size_t zeros = kWordBits - PopCount(words_[w]);
+      if (k < zeros) break;
+      k -= zeros;
+    }
+    return w * kWordBits + SelectInWord(~words_[w], k);
+  }
+
+  /// Number of consecutive ones from pos on
+  std::size_t OnesFrom(std::size_t pos) const {
+    std::size_t w = pos / kWordBits;
+    uint64_t rest = ~words_[w] >> (pos % kWordBits);
+    if (rest) {
+      return static_cast<std::size_t>(__builtin_ctzll(rest));
+    }
+    std::size_t n = kWordBits - pos % kWordBits;
+    for (++w; ~words_[w] == 0; ++w) {
+      n += kWordBits;
+    }
+    return n + static_cast<std::size_t>(__builtin_ctzll(~words_[w]));
+  }
+
+  /// Bytes of the bits and their directories
+  std::size_t MemoryBytes() const {
+    return words_.size() * sizeof(uint64_t) + ranks_.size() * sizeof(std::size_t)
+        + zero_samples_.size() * sizeof(uint32_t);
+  }
+
+  /// Bytes allocated, at least MemoryBytes
+  std::size_t CapacityBytes() const {
+    return words_.capacity() * sizeof(uint64_t) + ranks_.capacity() * sizeof(std::size_t)
+        + zero_samples_.capacity() * sizeof(uint32_t);
+  }
+
+  void ShrinkToFit() {
+    std::vector<uint64_t>(words_).swap(words_);
+    std::vector<std::size_t>(ranks_).swap(ranks_);
+    std::vector<uint32_t>(zero_samples_).swap(zero_samples_);
+  }
+
+ private:
+  static const std::size_t kWordBits = 64;
+  static const std::size_t kBlockWords = 8;
+  static const std::size_t kBlockBits = kWordBits * kBlockWords;
+  static const std::size_t kSampleRate = 512;  ///< One zero_samples_ entry per this many zeros
+
+  static std::size_t PopCount(uint64_t word) {
+    return static_cast<std::size_t>(__builtin_popcountll(word));
+  }
+
+  /// Position of the set bit of word with k set bits below it
+  static std::size_t SelectInWord(uint64_t word, std::size_t k) {
+    for (; k > 0; --k) {
+      word &= word - 1;
+    }
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+  }
+
+  std::size_t size_;
+  std::size_t num_ones_;
+  std::vector<uint64_t> words_;
+  std::vector<std::size_t> ranks_;      ///< Ones before each block, plus a sentinel
+  std::vector<uint32_t> zero_samples_;  ///< Block of every kSampleRate-th zero
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_BIT_VECTOR_H_
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <stdint.h>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "bit_vector.h"
+
+namespace balgo {
+
+/// Checks Get, Rank1, Select0 and OnesFrom against the plain bits
+void TestBitVector(const std::vector<bool>& bits) {
+  BitVector bv;
+  for (size_t i = 0; i < bits.size(); ++i) {
+    bv.PushBack(bits[i]);
+  }
+  bv.Build();
+  ASSERT_EQ(bits.size(), bv.size());
+  // the run of ones from each position, in one backward pass
+  std::vector<size_t> runs(bits.size() + 1, 0);
+  for (size_t i = bits.size(); i-- > 0; ) {
+    runs[i] = bits[i] ? runs[i + 1] + 1 : 0;
+  }
+  size_t ones = 0;
+  size_t zeros = 0;
+  for (size_t i = 0; i < bits.size(); ++i) {
+    ASSERT_EQ(bits[i], bv.Get(i)) << " pos: " << i;
+    ASSERT_EQ(ones, bv.Rank1(i)) << " pos: " << i;
+    if (bits[i]) {
+      ++ones;
+    } else {
+      ASSERT_EQ(i, bv.Select0(zeros)) << " zero: " << zeros;
+      ++zeros;
+    }
+    ASSERT_EQ(runs[i], bv.OnesFrom(i)) << " pos: " << i;
+  }
+  EXPECT_EQ(ones, bv.Rank1(bits.size()));
+  EXPECT_EQ(ones, bv.num_ones());
+  EXPECT_EQ(zeros, bv.num_zeros());
+}
+
+TEST(BitVector, Empty) {
+  TestBitVector(std::vector<bool>());
+  BitVector bv;
+  bv.Build();
+  EXPECT_EQ(0U, bv.Rank1(0));
+}
+
+TEST(BitVector, Random) {
+  uint64_t seed = 88172645463325252ULL;
+  const size_t kSizes[] = { 1, 63, 64, 65, 511, 512, 513, 5000, 70000 };
+  // densities from mostly zeros to mostly ones, with long runs of each
+  const uint32_t kDensities[] = { 1, 50, 99, 100 };
+  for (size_t s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); ++s) {
+    for (size_t d = 0; d < sizeof(kDensities) / sizeof(kDensities[0]); ++d) {
+      std::vector<bool> bits(kSizes[s]);
+      for (size_t i = 0; i < bits.size(); ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        bits[i] = seed % 100 < kDensities[d];
+      }
+      TestBitVector(bits);
+    }
+  }
+}
+
+TEST(BitVector, Runs) {
+  std::vector<bool> bits;
+  for (size_t run = 0; run < 300; run += 7) {
+    bits.insert(bits.end(), run, true);
+    bits.insert(bits.end(), run % 3 + 1, false);
+  }
+  TestBitVector(bits);
+}
+
+}  // namespace balgo
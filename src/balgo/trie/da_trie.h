@@ -29,10 +29,27 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <queue>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#if defined(__GLIBCXX__)
+#include <parallel/algorithm>
+#endif
+#endif
+
+#include "alphabet.h"
+#include "mappable_vector.h"
+#include "mapped_file.h"
+#include "memory_stats.h"
 #include "trie_traits.h"
 #include "trie.h"
 
@@ -44,16 +61,24 @@ namespace balgo {
 template<typename Char = char, typename Value = uint32_t, typename NodePtr = uint32_t>
 class DaTrie : public Trie<Char, Value, NodePtr> {
  public:
+  typedef Trie<Char, Value, NodePtr> Base;
   typedef typename TrieTraits<Char>::UChar UChar;
 
   struct Node;
   struct AuxUnit;
+  struct BlockInfo;
   struct Key;
-  typedef std::vector<Node> NodeContainer;
+  typedef MappableVector<Node> NodeContainer;
+  typedef MappableVector<uint32_t> PackedContainer;
   typedef std::vector<AuxUnit> AuxContainer;
+  typedef std::vector<BlockInfo> BlockContainer;
+  typedef std::vector<uint64_t> BitContainer;
   typedef std::vector<Key> KeyContainer;
   typedef std::vector<NodePtr> KidContainer;
-  typedef std::vector<Value> ValueContainer;
+  typedef MappableVector<Value> ValueContainer;
+  typedef MappableVector<Char> TailContainer;
+  typedef MappableVector<NodePtr> LeafContainer;
+  typedef balgo::Alphabet<Char> AlphabetType;
 
   struct Node {
     NodePtr base;
@@ -128,14 +153,30 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     KeyContainer& keys_;
   };
 
+  /**
+   * @brief Links of a free unit in the free list
+   *
+   * Only units of open blocks are linked, so AuxUnits are kept for the last
+   * kNumOpenBlocks blocks only and indexed by unit index modulo the window.
+   */
   struct AuxUnit {
     NodePtr prev;
     NodePtr next;
-    bool used;
     AuxUnit()
         : prev(Null()),
-          next(Null()),
-          used(false) {
+          next(Null()) {
+    }
+  };
+
+  /**
+   * @brief Free-space state of an open block
+   */
+  struct BlockInfo {
+    NodePtr num_trials;  ///< Failed Fetch attempts starting in this block
+    bool closed;         ///< Its free units have been dropped from the free list
+    BlockInfo()
+        : num_trials(0),
+          closed(false) {
     }
   };
 
@@ -147,20 +188,581 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     return 0;
   }
 
+  /**
+   * @brief Cursor over the keys starting with a prefix, see PredictiveSearch
+   *
+   * Each Next moves to the following key in lexicographic order of the
+   * unsigned chars. The key buffer and the stack of visited nodes are reused,
+   * so only their growth allocates. The trie must outlive the cursor and
+   * stay unchanged while it is used.
+   */
+  class Cursor {
+   public:
+    Cursor()
+        : trie_(NULL),
+          value_(NULL) {
+    }
+
+    /// Moves to the next key, returning false when there is none
+    bool Next() {
+      while (!frames_.empty()) {
+        Frame& frame = frames_.back();
+        key_.resize(frame.depth);
+        NodePtr tail = trie_->IsPacked() ? Null() : trie_->TailOf(frame.node);
+        if (tail != Null()) {
+          // the rest of the only key below is in the tail
+          bool first = frame.next == 0;
+          frames_.pop_back();
+          if (first) {
+            NodePtr pos = tail & ~TailFlag();
+            for (; trie_->tail_[pos] != NullChar(); ++pos) {
+              key_.push_back(trie_->tail_[pos]);
+            }
+            value_ = &trie_->values_[trie_->TailValueIndex(pos + 1)];
+            return true;
+          }
+          continue;
+        }
+        NodePtr child = trie_->NextChild(frame.node, &frame.next);
+        if (child == Null()) {
+          frames_.pop_back();
+          continue;
+        }
+        Char label = trie_->LabelOfRank(frame.next++);
+        if (label == NullChar()) {
+          value_ = trie_->GetValue(frame.node);
+          return true;
+        }
+        key_.push_back(label);
+        frames_.push_back(Frame(child, key_.size()));
+      }
+      value_ = NULL;
+      return false;
+    }
+
+    /// The current key, including the prefix
+    const std::basic_string<Char>& key() const {
+      return key_;
+    }
+
+    const Value& value() const {
+      return *value_;
+    }
+
+   private:
+    friend class DaTrie;
+
+    /// A node on the current path and the next label to probe below it
+    struct Frame {
+      NodePtr node;
+      std::size_t next;
+      std::size_t depth;
+      Frame(NodePtr n, std::size_t d)
+          : node(n),
+            next(0),
+            depth(d) {
+      }
+    };
+
+    void Reset(const DaTrie* trie, const Char* begin, const Char* end) {
+      trie_ = trie;
+      value_ = NULL;
+      frames_.clear();
+      key_.assign(begin, end);
+      if (trie->NumNodes() <= trie->Root()) {
+        return;
+      }
+      NodePtr node = trie->Root();
+      for (; begin != end; ++begin) {
+        node = trie->Child(node, *begin);
+        if (node == Null()) {
+          return;
+        }
+      }
+      frames_.push_back(Frame(node, key_.size()));
+    }
+
+    const DaTrie* trie_;
+    std::vector<Frame> frames_;
+    std::basic_string<Char> key_;
+    const Value* value_;
+  };
+
+  DaTrie()
+      : packed_(false),
+        packing_(false),
+        parallel_(false),
+        tail_enabled_(false),
+        tailing_(false),
+        dynamic_(false),
+        dense_ids_(false),
+        dense_(false),
+        remap_(false),
+        remapped_(false),
+        parent_alphabet_(NULL),
+        code_begin_(0),
+        code_end_(0),
+        peak_bytes_(0),
+        free_head_(Null()) {
+  }
   virtual ~DaTrie() { }
 
+  /**
+   * Selects the packed unit layout for the next Build.
+   * A packed unit is one 32-bit word holding the incoming label, a has-value
+   * flag and the base as an offset from the unit's own index, in the style of
+   * darts-clone; a terminal unit holds the value index instead. Bases are kept
+   * unique while packing, so a child is verified by comparing its label. Only
+   * single-byte Char is supported; wider Chars keep the plain layout.
+   */
+  void set_packed(bool packed) {
+    packed_ = packed;
+  }
+
+  bool packed() const {
+    return packed_;
+  }
+
+  /**
+   * Selects the parallel build for the next Build.
+   * Keys are sorted in parallel and the subtree under each first label is
+   * built on its own OpenMP thread, then relocated into one double-array.
+   * The lookup results are the same as those of the serial build. Without
+   * OpenMP, or with the packed layout, the build stays serial.
+   */
+  void set_parallel(bool parallel) {
+    parallel_ = parallel;
+  }
+
+  bool parallel() const {
+    return parallel_;
+  }
+
+  /**
+   * Selects tail compression for the next Build.
+   * Once a subtree holds a single key, the rest of that key is stored in a
+   * tail buffer, followed by NullChar and its value index, instead of a chain
+   * of one-child units. Positions inside a tail are node pointers with the
+   * top bit set. Tails are not used with the packed layout.
+   */
+  void set_tail(bool tail) {
+    tail_enabled_ = tail;
+  }
+
+  bool tail() const {
+    return tail_enabled_;
+  }
+
+  /**
+   * Selects dense key ids for the next Build.
+   * The value index of a key becomes its id: its rank among the distinct
+   * keys, 0 to NumKeys() - 1, and values_ keeps one value per distinct key.
+   * The unit of each id is recorded as well, so that KeyOf rebuilds a key by
+   * following checks up to the root. Keys inserted later take the next ids,
+   * and the ids of erased keys are not reused. The packed layout, which has
+   * no checks, supports IdOf only.
+   */
+  void set_dense_ids(bool dense_ids) {
+    dense_ids_ = dense_ids;
+  }
+
+  bool dense_ids() const {
+    return dense_ids_;
+  }
+
+  /**
+   * Selects the alphabet remap for the next Build.
+   * The labels that occur in the keys get dense codes by descending
+   * frequency, see Alphabet, and a child sits at base + code instead of
+   * base + label. Wide Chars, and bytes of UTF-8 text such as CJK, then need
+   * far fewer units, and single-byte codes let the packed layout take any
+   * Char. Labels first seen by Insert after Build get the next codes.
+   * Without the remap, listing the children of a node, as Insert, Erase and
+   * the traversals do, probes every label between the smallest and the
+   * largest in the keys, which for wide Chars can be thousands per node.
+   * DaTrieBuilder does not remap.
+   */
+  void set_alphabet(bool remap) {
+    remap_ = remap;
+  }
+
+  bool alphabet() const {
+    return remap_;
+  }
+
+  /// Number of ids given by dense_ids, including those of erased keys
+  std::size_t NumKeys() const {
+    return dense_ ? values_.size() : 0;
+  }
+
+  /// Finds the dense id of a key, which is its value index
+  bool IdOf(const Char* begin, const Char* end, NodePtr* id) const {
+    if (!dense_ || NumNodes() <= Root()) {
+      return false;
+    }
+    NodePtr p = Root();
+    for (; begin != end; ++begin) {
+      p = Child(p, *begin);
+      if (IsNull(p)) {
+        return false;
+      }
+    }
+    const Value* value = IsFinal(p) ? GetValue(p) : NULL;
+    if (!value) {
+      return false;
+    }
+    *id = static_cast<NodePtr>(value - values_.data());
+    return true;
+  }
+
+  bool IdOf(const Char* begin, NodePtr* id) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return IdOf(begin, begin + length, id);
+  }
+
+  /**
+   * Rebuilds the key with a dense id in O(key length).
+   * @return false if there is no such key or the layout is packed
+   */
+  bool KeyOf(NodePtr id, std::basic_string<Char>* key) const {
+    if (id >= leaves_.size() || leaves_[id] == Null()) {
+      return false;
+    }
+    NodePtr leaf = leaves_[id];
+    NodePtr node = IsTail(leaf) ? (leaf & ~TailFlag()) : units_[leaf].check;
+    key->clear();
+    for (NodePtr p = node; p != Root(); ) {
+      NodePtr parent = units_[p].check;
+      key->push_back(LabelOf(p - units_[parent].base));
+      p = parent;
+    }
+    std::reverse(key->begin(), key->end());
+    if (IsTail(leaf)) {
+      for (NodePtr pos = units_[node].base & ~TailFlag(); tail_[pos] != NullChar(); ++pos) {
+        key->push_back(tail_[pos]);
+      }
+    }
+    return true;
+  }
+
   virtual std::size_t NodeSize() const {
-    return sizeof(Node);
+    return IsPacked() ? sizeof(uint32_t) : sizeof(Node);
   }
 
   virtual std::size_t NumNodes() const {
-    return units_.size();
+    return IsPacked() ? packed_units_.size() : units_.size();
   }
 
   virtual std::string Name() const {
     return "DaTrie";
   }
 
+  /// Counting the used units scans the whole array
+  virtual MemoryStats MemoryUsage() const {
+    MemoryStats stats;
+    stats.nodes = SizeInBytes(units_) + SizeInBytes(packed_units_);
+    stats.values = SizeInBytes(values_);
+    stats.extra = SizeInBytes(tail_) + SizeInBytes(leaves_) + alphabet_.MemoryBytes();
+    stats.build = BuildBytes();
+    stats.slack = SlackInBytes(units_) + SlackInBytes(packed_units_) + SlackInBytes(values_)
+        + SlackInBytes(tail_) + SlackInBytes(leaves_);
+    stats.mapped = MappedBytes(units_) + MappedBytes(packed_units_) + MappedBytes(values_)
+        + MappedBytes(tail_) + MappedBytes(leaves_);
+    stats.peak = peak_bytes_;
+    std::size_t used = 0;
+    for (std::size_t i = Root(); i < units_.size(); ++i) {
+      used += units_[i].check != Null();
+    }
+    for (std::size_t i = Root(); i < packed_units_.size(); ++i) {
+      used += packed_units_[i] != kPackedEmpty;
+    }
+    if (NumNodes()) {
+      stats.fill_ratio = static_cast<double>(used) / static_cast<double>(NumNodes());
+    }
+    return stats;
+  }
+
+  /**
+   * Frees the key ids and free-space tracker kept after Build or updates,
+   * and the unused capacity of the arrays. The next update rebuilds the
+   * tracker.
+   */
+  virtual void ShrinkToFit() {
+    if (!this->IsBuilt()) {
+      return;
+    }
+    KidContainer().swap(kids_);
+    std::vector<NodePtr>().swap(closing_);
+    ReleaseBuild();
+    dynamic_ = false;
+    units_.shrink_to_fit();
+    packed_units_.shrink_to_fit();
+    values_.shrink_to_fit();
+    tail_.shrink_to_fit();
+    leaves_.shrink_to_fit();
+  }
+
+  virtual std::string StatsString() const {
+    std::stringstream ss;
+    ss << Base::StatsString();
+    if (IsPacked()) {
+      ss << ", unpacked_node_size=" << sizeof(Node) << ", unpacked_size="
+          << static_cast<double>(sizeof(Node)) * NumNodes() / (1 << 20) << "M";
+    }
+    if (!tail_.empty()) {
+      ss << ", tail_size=" << static_cast<double>(sizeof(Char)) * tail_.size() / (1 << 20) << "M";
+    }
+    return ss.str();
+  }
+
+  /**
+   * Saves the built trie to path in the format mapped by Open.
+   * Units and values are written raw in host byte order, so Value must be
+   * trivially copyable and the file is only portable across like hosts.
+   */
+  bool Save(const std::string& path) const {
+    static_assert(std::is_trivially_copyable<Value>::value,
+                  "DaTrie::Save requires a trivially copyable Value");
+    if (!this->IsBuilt()) {
+      return false;
+    }
+    std::vector<FileBlob> blobs;
+    if (IsPacked()) {
+      blobs.push_back(Blob(kPackedUnitsSection, packed_units_));
+    } else {
+      blobs.push_back(Blob(kUnitsSection, units_));
+    }
+    blobs.push_back(Blob(kValuesSection, values_));
+    blobs.push_back(Blob(kTailSection, tail_));
+    if (dense_) {
+      // written even when empty, as with the packed layout, to mark dense ids
+      blobs.push_back(Blob(kLeavesSection, leaves_));
+    }
+    if (remapped_) {
+      const typename AlphabetType::LabelContainer& labels = alphabet_.labels();
+      FileBlob blob = { kAlphabetSection, sizeof(UChar),
+                        reinterpret_cast<const char*>(&labels[0]), labels.size() };
+      blobs.push_back(blob);
+    }
+    NodePtr code_range[2] = { code_begin_, code_end_ };
+    if (!remapped_) {
+      FileBlob blob = { kCodeRangeSection, sizeof(NodePtr),
+                        reinterpret_cast<const char*>(code_range), 2 };
+      blobs.push_back(blob);
+    }
+    return WriteFile(path, blobs);
+  }
+
+  /**
+   * Maps a file written by Save without copying it.
+   * Lookups read the mapping directly, so processes opening the same file
+   * share its pages. The trie is left unchanged if the file is invalid.
+   */
+  bool Open(const std::string& path) {
+    static_assert(std::is_trivially_copyable<Value>::value,
+                  "DaTrie::Open requires a trivially copyable Value");
+    std::shared_ptr<MappedFile> file(new MappedFile);
+    if (!file->Open(path)) {
+      return false;
+    }
+    const FileSection* units = NULL;
+    const FileSection* packed_units = NULL;
+    const FileSection* values = NULL;
+    if (!ReadHeader(*file)
+        || !(values = FindSection(*file, kValuesSection, sizeof(Value)))) {
+      return false;
+    }
+    const FileSection* tail = FindSection(*file, kTailSection, sizeof(Char));
+    const FileSection* leaves = FindSection(*file, kLeavesSection, sizeof(NodePtr));
+    const FileSection* alphabet = FindSection(*file, kAlphabetSection, sizeof(UChar));
+    const FileSection* code_range = FindSection(*file, kCodeRangeSection, sizeof(NodePtr));
+    units = FindSection(*file, kUnitsSection, sizeof(Node));
+    if (!units) {
+      packed_units = FindSection(*file, kPackedUnitsSection, sizeof(uint32_t));
+      if (!packed_units) {
+        return false;
+      }
+    }
+    this->Clear();
+    if (units) {
+      units_.Map(reinterpret_cast<const Node*>(file->data() + units->offset),
+                 static_cast<std::size_t>(units->count), file);
+    } else {
+      packed_units_.Map(reinterpret_cast<const uint32_t*>(file->data() + packed_units->offset),
+                        static_cast<std::size_t>(packed_units->count), file);
+    }
+    values_.Map(reinterpret_cast<const Value*>(file->data() + values->offset),
+                static_cast<std::size_t>(values->count), file);
+    if (tail) {
+      tail_.Map(reinterpret_cast<const Char*>(file->data() + tail->offset),
+                static_cast<std::size_t>(tail->count), file);
+    }
+    dense_ = leaves != NULL;
+    if (leaves) {
+      leaves_.Map(reinterpret_cast<const NodePtr*>(file->data() + leaves->offset),
+                  static_cast<std::size_t>(leaves->count), file);
+    }
+    if (alphabet) {
+      const UChar* labels = reinterpret_cast<const UChar*>(file->data() + alphabet->offset);
+      alphabet_.Assign(labels, labels + alphabet->count);
+      remapped_ = true;
+    } else if (code_range && code_range->count == 2) {
+      const NodePtr* range = reinterpret_cast<const NodePtr*>(file->data() + code_range->offset);
+      code_begin_ = range[0];
+      code_end_ = range[1];
+    } else {
+      // written before the range was saved; no code reaches past the units
+      code_end_ = static_cast<NodePtr>(std::min(MaxCodes(), NumNodes()));
+    }
+    this->MarkBuilt();
+    return true;
+  }
+
+  /**
+   * Matches n keys, keys[i] being lengths[i] chars long, and stores the value
+   * of each key found in values[i] and whether it was found in found[i];
+   * values and found may be NULL. Keys are stepped in groups of kBatchSize,
+   * one level per round, and the unit each key visits next is prefetched, so
+   * the cache misses of a group overlap instead of following one another.
+   * @return the number of keys found
+   */
+  std::size_t MatchBatch(const Char* const* keys, const std::size_t* lengths, std::size_t n,
+                         Value* values, bool* found) const {
+    std::size_t cnt = 0;
+    for (std::size_t first = 0; first < n; first += kBatchSize) {
+      cnt += MatchGroup(keys + first, lengths + first,
+                        std::min(n - first, static_cast<std::size_t>(kBatchSize)),
+                        values ? values + first : NULL, found ? found + first : NULL);
+    }
+    return cnt;
+  }
+
+  /// Matches n null-terminated keys, see above
+  std::size_t MatchBatch(const Char* const* keys, std::size_t n, Value* values,
+                         bool* found) const {
+    std::size_t cnt = 0;
+    std::size_t lengths[kBatchSize];
+    for (std::size_t first = 0; first < n; first += kBatchSize) {
+      std::size_t size = std::min(n - first, static_cast<std::size_t>(kBatchSize));
+      for (std::size_t i = 0; i < size; ++i) {
+        lengths[i] = std::char_traits<Char>::length(keys[first + i]);
+      }
+      cnt += MatchGroup(keys + first, lengths, size, values ? values + first : NULL,
+                        found ? found + first : NULL);
+    }
+    return cnt;
+  }
+
+  /**
+   * Renumbers the units so that the nodes the n sample queries visit most
+   * come first. Sibling sets are placed again, best first by visits and
+   * then depth first, each at the lowest free base, so the hot part of the
+   * trie shares cache lines and pages while the paths of the unvisited
+   * keys stay together. Keys, values and dense ids are unchanged. The
+   * packed layout cannot be relaid out.
+   * @return whether the units were relaid out
+   */
+  bool Relayout(const Char* const* queries, const std::size_t* lengths, std::size_t n) {
+    if (!this->IsBuilt() || IsPacked() || NumNodes() <= Root()) {
+      return false;
+    }
+    DetachArrays();  // the units are written in place
+    std::vector<uint32_t> visits(units_.size());
+    this->CountVisits(queries, lengths, n, &visits);
+
+    // record the sibling sets in their new order while the old units are there
+    std::vector<RelayoutSet> sets;
+    std::vector<Char> labels;
+    std::vector<NodePtr> kids;  // old child, or value index, of each label
+    std::priority_queue<RelayoutEntry> queue;
+    std::size_t order = 0;
+    queue.push(RelayoutEntry(visits[Root()], order++, Root()));
+    while (!queue.empty()) {
+      NodePtr node = queue.top().node;
+      queue.pop();
+      NodePtr base = units_[node].base;
+      sets.push_back(RelayoutSet(node, base, labels.size()));
+      std::size_t first = labels.size();
+      ChildLabels(node, &labels);
+      for (std::size_t i = first; i < labels.size(); ++i) {
+        NodePtr child = base + Code(labels[i]);
+        if (labels[i] == NullChar()) {
+          kids.push_back(units_[child].GetValueIndex());
+        } else {
+          kids.push_back(child);
+          queue.push(RelayoutEntry(visits[child], order++, child));
+        }
+      }
+    }
+    sets.push_back(RelayoutSet(Null(), Null(), labels.size()));
+
+    std::vector<NodePtr> new_of(units_.size(), Null());
+    TailContainer tail(tail_);  // kept by the new units
+    InitUnits();
+    tail_ = tail;
+    new_of[Root()] = Root();
+    std::vector<Char> set_labels;
+    for (std::size_t s = 0; s + 1 < sets.size(); ++s) {
+      NodePtr node = new_of[sets[s].node];
+      set_labels.assign(labels.begin() + static_cast<std::ptrdiff_t>(sets[s].first),
+                        labels.begin() + static_cast<std::ptrdiff_t>(sets[s + 1].first));
+      if (set_labels.empty()) {
+        Unit(node).base = sets[s].base;  // a tail, or no child at all
+        continue;
+      }
+      NodePtr base = Fetch(node, set_labels);
+      Unit(node).base = base;
+      InsertUnits(node, base, set_labels);
+      for (std::size_t i = 0; i < set_labels.size(); ++i) {
+        NodePtr child = base + Code(set_labels[i]);
+        NodePtr kid = kids[sets[s].first + i];
+        if (set_labels[i] == NullChar()) {
+          Unit(child).SetValueIndex(kid);
+        } else {
+          new_of[kid] = child;
+        }
+      }
+    }
+    if (dense_) {
+      BuildLeaves();
+    }
+    UpdatePeak();
+    ReleaseBuild();
+    return true;
+  }
+
+  /// Relays out for n null-terminated queries, see above
+  bool Relayout(const Char* const* queries, std::size_t n) {
+    std::vector<std::size_t> lengths(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      lengths[i] = std::char_traits<Char>::length(queries[i]);
+    }
+    return Relayout(queries, n ? &lengths[0] : NULL, n);
+  }
+
+  /**
+   * Starts enumerating the keys that begin with [begin, end), the empty
+   * prefix giving every key; cursor may be reused across searches.
+   */
+  void PredictiveSearch(const Char* begin, const Char* end, Cursor* cursor) const {
+    cursor->Reset(this, begin, end);
+  }
+
+  Cursor PredictiveSearch(const Char* begin, const Char* end) const {
+    Cursor cursor;
+    PredictiveSearch(begin, end, &cursor);
+    return cursor;
+  }
+
+  Cursor PredictiveSearch(const Char* begin, std::size_t length) const {
+    return PredictiveSearch(begin, begin + length);
+  }
+
+  Cursor PredictiveSearch(const Char* begin) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return PredictiveSearch(begin, begin + length);
+  }
+
   std::string ToString() const {
     std::stringstream ss;
     for (std::size_t i = Root(); i < units_.size(); ++i) {
@@ -168,6 +770,11 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
         ss << "[" << i << "] " << units_[i].ToString() << "\n";
       }
     }
+    for (std::size_t i = Root(); i < packed_units_.size(); ++i) {
+      if (packed_units_[i] != kPackedEmpty) {
+        ss << "[" << i << "] " << std::hex << packed_units_[i] << std::dec << "\n";
+      }
+    }
     return ss.str();
   }
 
@@ -177,7 +784,21 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
   }
 
   NodePtr Child(const NodePtr parent, Char label) const {
-    NodePtr child = units_[parent].base + Index(label);
+    if (IsPacked()) {
+      return PackedChild(parent, label);
+    }
+    if (IsTail(parent)) {
+      return TailChild(parent & ~TailFlag(), label);
+    }
+    NodePtr base = units_[parent].base;
+    if (IsTail(base)) {
+      return TailChild(base & ~TailFlag(), label);
+    }
+    NodePtr code = Code(label);
+    if (code == AlphabetType::Absent()) {
+      return Null();
+    }
+    NodePtr child = base + code;
     if (child < units_.size() && units_[child].check == parent) {
       return child;
     }
@@ -189,10 +810,32 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
   }
 
   virtual bool IsFinal(const NodePtr node) const {
+    if (IsPacked()) {
+      return (packed_units_[node] & kPackedHasLeaf) != 0;
+    }
+    NodePtr tail = TailOf(node);
+    if (tail != Null()) {
+      return tail_[tail & ~TailFlag()] == NullChar();
+    }
     return units_[units_[node].base].check == node;
   }
 
   virtual const Value* GetValue(NodePtr p) const {
+    if (IsPacked()) {
+      if (!IsFinal(p)) {
+        return NULL;
+      }
+      NodePtr leaf = p ^ PackedOffset(packed_units_[p]);
+      return &(values_[packed_units_[leaf] & kPackedValueMask]);
+    }
+    NodePtr tail = TailOf(p);
+    if (tail != Null()) {
+      tail &= ~TailFlag();
+      if (tail_[tail] != NullChar()) {
+        return NULL;
+      }
+      return &(values_[TailValueIndex(tail + 1)]);
+    }
     if (IsFinal(p)) {
       NodePtr kid = units_[units_[p].base].GetValueIndex();
       return &(values_[kid]);
@@ -200,6 +843,27 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     return NULL;
   }
 
+  virtual NodePtr NextChild(NodePtr parent, std::size_t* next, Char* label) const {
+    NodePtr tail = IsPacked() ? Null() : TailOf(parent);
+    if (tail != Null()) {
+      // the only child in a tail is the next char of its key
+      tail &= ~TailFlag();
+      if (*next != 0 || tail_[tail] == NullChar()) {
+        return Null();
+      }
+      *next = 1;
+      *label = tail_[tail];
+      return (tail + 1) | TailFlag();
+    }
+    // rank 0 is the value of a final node
+    *next = std::max<std::size_t>(*next, 1);
+    NodePtr child = NextChild(parent, next);
+    if (child != Null()) {
+      *label = LabelOfRank((*next)++);
+    }
+    return child;
+  }
+
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
     if (begin != end) {
       std::size_t length = static_cast<std::size_t>(std::distance(begin, end));
@@ -214,46 +878,633 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
       kids_.push_back(static_cast<NodePtr>(i));
     }
     if (sort) {
-      std::sort(kids_.begin(), kids_.end(), KeyIdLess(keys_));
+      SortKids();
       typename KidContainer::iterator new_end = std::unique(kids_.begin(), kids_.end(),
                                                             KeyIdEqual(keys_));
       std::size_t new_size = static_cast<std::size_t>(std::distance(kids_.begin(), new_end));
       kids_.resize(new_size);
     }
-    // init auxes_
-    static const NodePtr kFreeHead = (1 << (sizeof(UChar) * 8)) + Root();
-    free_head_ = kFreeHead;
-    units_.resize(free_head_ + 1);
-    auxes_.resize(free_head_ + 1);
-    auxes_[free_head_].prev = free_head_;
-    auxes_[free_head_].next = free_head_;
-
-    Unit(Root()).check = Root();
+    peak_bytes_ = 0;
+    UpdatePeak();
+    remapped_ = remap_;
+    if (remapped_ && !parent_alphabet_) {
+      BuildAlphabet();
+    } else if (!remapped_) {
+      FindCodeRange();
+    }
+    std::size_t num_codes = remapped_ ? CurrentAlphabet().size() : MaxCodes();
+    packing_ = packed_ && num_codes <= kPackedLabelMask + 1 && keys_.size() <= kPackedValueMask;
+    tailing_ = tail_enabled_ && !packing_;
+    dense_ = dense_ids_;
+    InitUnits();
 
+#if defined(_OPENMP)
+    if (parallel_ && !packing_) {
+      BuildSubtrees();
+    } else {
+      BuildNode(0, Root(), 0, static_cast<NodePtr>(kids_.size()));
+    }
+#else
     BuildNode(0, Root(), 0, static_cast<NodePtr>(kids_.size()));
-
-    // release auxes_
-    KeyContainer().swap(keys_);
-    AuxContainer().swap(auxes_);
+#endif
+    if (dense_) {
+      CompactValues();
+    }
+    if (packing_ && Pack()) {
+      UpdatePeak();
+      units_.Release();
+    }
+    if (dense_ && !IsPacked()) {
+      BuildLeaves();
+    }
+    UpdatePeak();
+    ReleaseBuild();
   }
 
   virtual void DoClear() {
+    dynamic_ = false;
+    dense_ = false;
+    remapped_ = false;
+    parent_alphabet_ = NULL;
+    alphabet_.Clear();
+    code_begin_ = 0;
+    code_end_ = 0;
+    peak_bytes_ = 0;
     units_.clear();
+    packed_units_.clear();
     values_.clear();
+    tail_.clear();
+    leaves_.clear();
     kids_.clear();
     keys_.clear();
+    used_.clear();
+    bases_.clear();
     auxes_.clear();
+    blocks_.clear();
+  }
+
+  /**
+   * Inserts a key into the built double-array, or replaces its value.
+   * A conflicting sibling set is relocated, the smaller of the two, and units
+   * freed by Erase are reused. Tails on the way are expanded into units. The
+   * packed layout cannot be updated.
+   */
+  virtual bool DoInsertBuilt(const Char* begin, const Char* end, const Value& value) {
+    if (begin == end || IsPacked()) {
+      return false;
+    }
+    Thaw();
+    if (remapped_) {
+      for (const Char* p = begin; p != end; ++p) {
+        alphabet_.Add(*p);
+      }
+    }
+    NodePtr node = Root();
+    for (const Char* p = begin; p != end; ++p) {
+      if (IsTail(units_[node].base)) {
+        ExpandTail(node);
+      }
+      node = AddChild(node, *p);
+    }
+    if (IsTail(units_[node].base)) {
+      ExpandTail(node);
+    }
+    if (IsFinal(node)) {
+      values_[units_[units_[node].base].GetValueIndex()] = value;
+      return true;
+    }
+    NodePtr leaf = AddChild(node, NullChar());
+    units_[leaf].SetValueIndex(static_cast<NodePtr>(values_.size()));
+    values_.push_back(value);
+    if (dense_) {
+      leaves_.push_back(leaf);
+    }
+    return true;
+  }
+
+  /**
+   * Erases a key from the built double-array.
+   * Its units are freed up to the nearest ancestor still in use; its value is
+   * left in values_ unreferenced.
+   */
+  virtual bool DoErase(const Char* begin, const Char* end) {
+    if (begin == end || IsPacked()) {
+      return false;
+    }
+    Thaw();
+    NodePtr node = Root();
+    const Char* p = begin;
+    for (; p != end && !IsTail(units_[node].base); ++p) {
+      node = Child(node, *p);
+      if (node == Null()) {
+        return false;
+      }
+    }
+    NodePtr base = units_[node].base;
+    if (IsTail(base)) {
+      NodePtr pos = base & ~TailFlag();
+      for (; p != end; ++p, ++pos) {
+        if (tail_[pos] != *p) {
+          return false;
+        }
+      }
+      if (tail_[pos] != NullChar()) {
+        return false;
+      }
+      if (dense_) {
+        leaves_[TailValueIndex(pos + 1)] = Null();
+      }
+      units_[node].base = Null();
+    } else {
+      if (!IsFinal(node)) {
+        return false;
+      }
+      if (dense_) {
+        leaves_[units_[base].GetValueIndex()] = Null();
+      }
+      Free(base);
+    }
+    Prune(node);
+    return true;
   }
 
  private:
+  template<typename, typename, typename> friend class DaTrie;
+  template<typename, typename, typename> friend class DaTrieBuilder;
+  template<typename> friend class StaticTrie;
+
+  /// A sibling set to place again in Relayout: the children of node, or its base
+  struct RelayoutSet {
+    NodePtr node;
+    NodePtr base;       ///< Old base, kept for a tail
+    std::size_t first;  ///< First label of the set in the recorded labels
+    RelayoutSet(NodePtr n, NodePtr b, std::size_t f) : node(n), base(b), first(f) { }
+  };
+
+  /// A node queued by Relayout; the queue pops most visits, then last queued
+  struct RelayoutEntry {
+    uint32_t visits;
+    std::size_t order;
+    NodePtr node;
+    RelayoutEntry(uint32_t v, std::size_t o, NodePtr n) : visits(v), order(o), node(n) { }
+    bool operator<(const RelayoutEntry& rhs) const {
+      return visits < rhs.visits || (visits == rhs.visits && order < rhs.order);
+    }
+  };
+
+  /// Header of the file written by Save, followed by the section table
+  struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t char_size;
+    uint32_t value_size;
+    uint32_t node_ptr_size;
+    uint32_t node_size;
+    uint32_t num_sections;
+  };
+
+  /// An array stored in the file at an offset aligned to kFileAlignment
+  struct FileSection {
+    uint32_t id;
+    uint32_t elem_size;
+    uint64_t offset;
+    uint64_t count;
+  };
+
+  struct FileBlob {
+    uint32_t id;
+    uint32_t elem_size;
+    const char* data;
+    uint64_t count;
+  };
+
+  enum {
+    kFileVersion = 1,
+    kFileAlignment = 64,
+    kUnitsSection = 1,
+    kValuesSection = 2,
+    kPackedUnitsSection = 3,
+    kTailSection = 4,
+    kLeavesSection = 5,
+    kAlphabetSection = 6,
+    kCodeRangeSection = 7
+  };
+
+  /// Chars taken by a value index stored in the tail
+  static const std::size_t kTailValueChars = (sizeof(NodePtr) + sizeof(Char) - 1) / sizeof(Char);
+
+  // Bits of a packed unit
+  static const uint32_t kPackedLabelMask = 0xFF;
+  static const uint32_t kPackedHasLeaf = 1U << 8;
+  static const uint32_t kPackedExtension = 1U << 9;
+  static const uint32_t kPackedLeaf = 1U << 31;
+  static const uint32_t kPackedValueMask = kPackedLeaf - 1;
+  /// An empty unit is a leaf, so it never matches a label
+  static const uint32_t kPackedEmpty = kPackedLeaf;
+  static const NodePtr kPackedMaxOffset = 1U << 21;
+
+  enum {
+    kBatchSize = 16,      ///< Keys stepped together by MatchBatch
+    kSubtrieBegin = 2,    ///< First unit after Null and Root
+    kBlockSize = 256,     ///< Units per block of the free-space tracker
+    kNumOpenBlocks = 16,  ///< Recent blocks whose free units are linked
+    kMaxTrials = 128       ///< Failed Fetches after which a block is closed
+  };
+
   static UChar Index(Char label) {
     return static_cast<UChar>(label);
   }
 
+  /// The alphabet of the trie, or of the trie a subtrie is built for
+  const AlphabetType& CurrentAlphabet() const {
+    return parent_alphabet_ ? *parent_alphabet_ : alphabet_;
+  }
+
+  /**
+   * The offset of the child for label from its parent's base, or Absent for
+   * a label the alphabet lacks, which callers test before adding a base.
+   */
+  NodePtr Code(Char label) const {
+    return remapped_ ? static_cast<NodePtr>(CurrentAlphabet().Code(label)) : Index(label);
+  }
+
+  Char LabelOf(NodePtr code) const {
+    return remapped_ ? CurrentAlphabet().Label(code) : static_cast<Char>(code);
+  }
+
+  /// Number of codes a Char can take without the remap
+  static std::size_t MaxCodes() {
+    return static_cast<std::size_t>(std::numeric_limits<UChar>::max()) + 1;
+  }
+
+  /// Smallest code after that of NullChar, where the probes for children resume
+  std::size_t FirstCode() const {
+    return remapped_ || code_begin_ == 0 ? 1 : code_begin_;
+  }
+
+  /// Bound on the codes of the children of any node
+  std::size_t NumCodes() const {
+    return remapped_ ? CurrentAlphabet().size() : code_end_;
+  }
+
+  /// Widens the range of raw codes probed for children to take code
+  void AddCode(NodePtr code) {
+    if (code != 0 && (code_begin_ == 0 || code < code_begin_)) {
+      code_begin_ = code;
+    }
+    code_end_ = std::max(code_end_, code + 1);
+  }
+
+  /// The code of the rank-th label in the order of Index
+  NodePtr CodeOfRank(std::size_t rank) const {
+    return static_cast<NodePtr>(remapped_ ? CurrentAlphabet().CodeOfRank(rank) : rank);
+  }
+
+  Char LabelOfRank(std::size_t rank) const {
+    return LabelOf(CodeOfRank(rank));
+  }
+
+  /// Counts the labels of the keys to be built and assigns their codes
+  void BuildAlphabet() {
+    alphabet_.Clear();
+    for (std::size_t i = 0; i < kids_.size(); ++i) {
+      const Key& key = keys_[kids_[i]];
+      for (std::size_t j = 0; j < key.length; ++j) {
+        alphabet_.Count(key.begin[j]);
+      }
+    }
+    alphabet_.Assign();
+  }
+
+  /// Bounds the raw codes by the smallest and largest labels of the keys to be built
+  void FindCodeRange() {
+    AddCode(Code(NullChar()));
+    for (std::size_t i = 0; i < kids_.size(); ++i) {
+      const Key& key = keys_[kids_[i]];
+      for (std::size_t j = 0; j < key.length; ++j) {
+        AddCode(Code(key.begin[j]));
+      }
+    }
+  }
+
+  bool IsPacked() const {
+    return !packed_units_.empty();
+  }
+
+  /// Marks a position in tail_, either as a base or as a node pointer
+  static NodePtr TailFlag() {
+    return static_cast<NodePtr>(static_cast<NodePtr>(1) << (sizeof(NodePtr) * 8 - 1));
+  }
+
+  static bool IsTail(NodePtr p) {
+    return (p & TailFlag()) != 0;
+  }
+
+  /// Returns the flagged tail position of node, or Null if node is not in a tail
+  NodePtr TailOf(NodePtr node) const {
+    if (IsTail(node)) {
+      return node;
+    }
+    NodePtr base = units_[node].base;
+    return IsTail(base) ? base : Null();
+  }
+
+  NodePtr TailChild(NodePtr pos, Char label) const {
+    if (label != NullChar() && tail_[pos] == label) {
+      return (pos + 1) | TailFlag();
+    }
+    return Null();
+  }
+
+  NodePtr TailValueIndex(NodePtr pos) const {
+    NodePtr idx = 0;
+    std::memcpy(&idx, tail_.data() + pos, sizeof(NodePtr));
+    return idx;
+  }
+
+  /// Appends key[depth..] and its value index to tail_, returning the flagged position
+  NodePtr AppendTail(const Key& key, std::size_t depth, NodePtr kid) {
+    NodePtr pos = static_cast<NodePtr>(tail_.size()) | TailFlag();
+    for (std::size_t i = depth; i < key.length; ++i) {
+      tail_.push_back(key.begin[i]);
+    }
+    tail_.push_back(NullChar());
+    Char buf[kTailValueChars] = { 0 };
+    std::memcpy(buf, &kid, sizeof(NodePtr));
+    for (std::size_t i = 0; i < kTailValueChars; ++i) {
+      tail_.push_back(buf[i]);
+    }
+    return pos;
+  }
+
+  static NodePtr PackedOffset(uint32_t unit) {
+    return (unit >> 10) << ((unit & kPackedExtension) >> 6);
+  }
+
+  /// An offset is stored in 21 bits, or in 21 bits shifted by 8
+  static bool IsPackableOffset(NodePtr offset) {
+    return offset < kPackedMaxOffset
+        || ((offset & 0xFF) == 0 && offset < (kPackedMaxOffset << 8));
+  }
+
+  static uint32_t PackOffset(NodePtr offset) {
+    if (offset < kPackedMaxOffset) {
+      return static_cast<uint32_t>(offset) << 10;
+    }
+    return (static_cast<uint32_t>(offset >> 8) << 10) | kPackedExtension;
+  }
+
+  NodePtr PackedChild(const NodePtr parent, Char label) const {
+    NodePtr code = Code(label);
+    if (code == AlphabetType::Absent()) {
+      return Null();
+    }
+    NodePtr child = (parent ^ PackedOffset(packed_units_[parent])) + code;
+    if (child < packed_units_.size()
+        && (packed_units_[child] & (kPackedLeaf | kPackedLabelMask)) == code) {
+      return child;
+    }
+    return Null();
+  }
+
+  /**
+   * Steps up to kBatchSize keys in lockstep. A round first computes the unit
+   * each key visits next and prefetches it, then verifies those units and
+   * moves on. The end of a key is the NullChar step to its value unit; a key
+   * that reaches a tail is compared there directly.
+   */
+  std::size_t MatchGroup(const Char* const* keys, const std::size_t* lengths, std::size_t n,
+                         Value* values, bool* found) const {
+    NodePtr nodes[kBatchSize];
+    NodePtr nexts[kBatchSize];
+    std::size_t depths[kBatchSize];
+    std::size_t active[kBatchSize];
+    std::size_t num_active = 0;
+    std::size_t cnt = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (found) {
+        found[i] = false;
+      }
+      if (lengths[i] && NumNodes() > Root()) {
+        nodes[i] = Root();
+        depths[i] = 0;
+        active[num_active++] = i;
+      }
+    }
+    while (num_active) {
+      for (std::size_t j = 0; j < num_active; ++j) {
+        std::size_t i = active[j];
+        Char label = depths[i] < lengths[i] ? keys[i][depths[i]] : NullChar();
+        nexts[i] = BatchNext(nodes[i], label);
+        Prefetch(nexts[i]);
+      }
+      std::size_t num_kept = 0;
+      for (std::size_t j = 0; j < num_active; ++j) {
+        std::size_t i = active[j];
+        Char label = depths[i] < lengths[i] ? keys[i][depths[i]] : NullChar();
+        NodePtr next = nexts[i];
+        NodePtr idx = Null();
+        if (IsTail(next)) {
+          if (MatchTail(next & ~TailFlag(), keys[i] + depths[i], keys[i] + lengths[i], &idx)) {
+            cnt += Found(idx, values ? values + i : NULL, found ? found + i : NULL);
+          }
+        } else if (!IsNull(next) && BatchVerify(nodes[i], next, label)) {
+          if (depths[i] == lengths[i]) {
+            idx = IsPacked() ? (packed_units_[next] & kPackedValueMask)
+                : units_[next].GetValueIndex();
+            cnt += Found(idx, values ? values + i : NULL, found ? found + i : NULL);
+          } else {
+            nodes[i] = next;
+            ++depths[i];
+            active[num_kept++] = i;
+          }
+        }
+      }
+      num_active = num_kept;
+    }
+    return cnt;
+  }
+
+  std::size_t Found(NodePtr idx, Value* value, bool* found) const {
+    if (value) {
+      *value = values_[idx];
+    }
+    if (found) {
+      *found = true;
+    }
+    return 1;
+  }
+
+  /// The unit node steps to for label if it has such a child, or a flagged tail position
+  NodePtr BatchNext(NodePtr node, Char label) const {
+    if (IsPacked()) {
+      uint32_t unit = packed_units_[node];
+      if (label == NullChar() && !(unit & kPackedHasLeaf)) {
+        return Null();
+      }
+      NodePtr code = Code(label);
+      return code == AlphabetType::Absent() ? Null() : (node ^ PackedOffset(unit)) + code;
+    }
+    NodePtr base = units_[node].base;
+    if (IsTail(base)) {
+      return base;
+    }
+    NodePtr code = Code(label);
+    return code == AlphabetType::Absent() ? Null() : base + code;
+  }
+
+  bool BatchVerify(NodePtr node, NodePtr next, Char label) const {
+    if (IsPacked()) {
+      return label == NullChar() || (next < packed_units_.size()
+          && (packed_units_[next] & (kPackedLeaf | kPackedLabelMask)) == Code(label));
+    }
+    return next < units_.size() && units_[next].check == node;
+  }
+
+  void Prefetch(NodePtr next) const {
+#if defined(__GNUC__)
+    if (IsPacked()) {
+      if (next < packed_units_.size()) {
+        __builtin_prefetch(packed_units_.data() + next);
+      }
+    } else if (next < units_.size()) {
+      __builtin_prefetch(units_.data() + next);
+    }
+#endif
+  }
+
+  /**
+   * Returns the first child of node whose label has at least rank *rank in
+   * the order of Index, setting *rank to that of its label, or Null. Rank 0
+   * is NullChar, whose child is the value unit of a final node. Labels are
+   * probed in order from FirstCode to NumCodes, as no sibling links are stored.
+   */
+  NodePtr NextChild(NodePtr node, std::size_t* rank) const {
+    std::size_t num_ranks = NumCodes();
+    if (IsPacked()) {
+      uint32_t unit = packed_units_[node];
+      NodePtr base = node ^ PackedOffset(unit);
+      if (*rank == 0 && (unit & kPackedHasLeaf)) {
+        return base;
+      }
+      for (*rank = std::max(*rank, FirstCode()); *rank < num_ranks; ++*rank) {
+        NodePtr code = CodeOfRank(*rank);
+        if (base + code < packed_units_.size()
+            && (packed_units_[base + code] & (kPackedLeaf | kPackedLabelMask)) == code) {
+          return base + code;
+        }
+      }
+      return Null();
+    }
+    NodePtr base = units_[node].base;
+    for (; *rank < num_ranks; *rank = std::max(*rank + 1, FirstCode())) {
+      NodePtr child = base + CodeOfRank(*rank);
+      if (child >= units_.size()) {
+        if (remapped_) {
+          continue;
+        }
+        break;  // the children of raw labels are in rank order
+      }
+      if (units_[child].check == node && child != Root()) {
+        return child;
+      }
+    }
+    return Null();
+  }
+
+  /// Whether the tail at pos holds exactly [begin, end), giving its value index
+  bool MatchTail(NodePtr pos, const Char* begin, const Char* end, NodePtr* idx) const {
+    for (; begin != end; ++begin, ++pos) {
+      if (tail_[pos] != *begin || *begin == NullChar()) {
+        return false;
+      }
+    }
+    if (tail_[pos] != NullChar()) {
+      return false;
+    }
+    *idx = TailValueIndex(pos + 1);
+    return true;
+  }
+
+  /**
+   * Converts the built units into packed_units_.
+   * Fails, keeping the plain layout, if some offset cannot be packed.
+   */
+  bool Pack() {
+    packed_units_.resize(units_.size(), static_cast<uint32_t>(kPackedEmpty));
+    for (NodePtr i = Root(); i < units_.size(); ++i) {
+      if (!IsUsed(i)) {
+        continue;
+      }
+      const Node& unit = units_[i];
+      NodePtr parent_base = units_[unit.check].base;
+      if (i != Root() && parent_base == i) {
+        packed_units_[i] = kPackedLeaf | static_cast<uint32_t>(unit.GetValueIndex());
+        continue;
+      }
+      NodePtr offset = unit.base ^ i;
+      if (!IsPackableOffset(offset)) {
+        packed_units_.clear();
+        return false;
+      }
+      uint32_t word = PackOffset(offset);
+      if (i != Root()) {
+        word |= static_cast<uint32_t>(i - parent_base);
+      }
+      if (units_[unit.base].check == i) {
+        word |= kPackedHasLeaf;
+      }
+      packed_units_[i] = word;
+    }
+    return true;
+  }
+
   Char Label(const NodePtr node) const {
     return units_[node].label;
   }
 
+  /// Starts the units of a Build with the free-space tracker
+  void InitUnits() {
+    dynamic_ = false;
+    units_.clear();
+    packed_units_.clear();
+    tail_.clear();
+    leaves_.clear();
+    used_.clear();
+    bases_.clear();
+    auxes_.assign(kBlockSize * kNumOpenBlocks, AuxUnit());
+    blocks_.assign(kNumOpenBlocks, BlockInfo());
+    free_head_ = Null();
+    Reserve(Null());  // Null is never a valid unit
+    Reserve(Root());
+    Unit(Root()).check = Root();
+  }
+
+  std::size_t BuildBytes() const {
+    return CapacityInBytes(keys_) + CapacityInBytes(kids_) + CapacityInBytes(used_)
+        + CapacityInBytes(bases_) + CapacityInBytes(auxes_) + CapacityInBytes(blocks_)
+        + CapacityInBytes(closing_);
+  }
+
+  template<typename T>
+  static std::size_t MappedBytes(const MappableVector<T>& vec) {
+    return vec.mapped() ? SizeInBytes(vec) : 0;
+  }
+
+  void UpdatePeak() {
+    std::size_t bytes = BuildBytes() + CapacityInBytes(units_) + CapacityInBytes(packed_units_)
+        + CapacityInBytes(values_) + CapacityInBytes(tail_);
+    peak_bytes_ = std::max(peak_bytes_, bytes);
+  }
+
+  void ReleaseBuild() {
+    KeyContainer().swap(keys_);
+    BitContainer().swap(used_);
+    BitContainer().swap(bases_);
+    AuxContainer().swap(auxes_);
+    BlockContainer().swap(blocks_);
+  }
+
   Node& Unit(const NodePtr index) {
     if (index >= units_.size()) {
       Resize(index + 1);
@@ -261,30 +1512,106 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     return units_[index];
   }
 
+  AuxUnit& Aux(const NodePtr index) {
+    return dynamic_ ? auxes_[index] : auxes_[index % (kBlockSize * kNumOpenBlocks)];
+  }
+
+  BlockInfo& Block(const NodePtr block) {
+    return dynamic_ ? blocks_[block] : blocks_[block % kNumOpenBlocks];
+  }
+
+  NodePtr NumBlocks() const {
+    return static_cast<NodePtr>(units_.size() / kBlockSize);
+  }
+
+  bool IsUsed(const NodePtr index) const {
+    return (used_[index / 64] >> (index % 64)) & 1;
+  }
+
+  /// While updating, every block is in the window
+  bool IsOpen(const NodePtr block) {
+    return (dynamic_ || block + kNumOpenBlocks >= NumBlocks()) && !Block(block).closed;
+  }
+
+  /// Grows units_ block by block, closing blocks that fall out of the window
   void Resize(std::size_t size) {
-    if (size <= units_.size())
+    while (units_.size() < size) {
+      NodePtr block = NumBlocks();
+      if (dynamic_) {
+        blocks_.push_back(BlockInfo());
+        auxes_.resize(units_.size() + kBlockSize);
+      } else if (block >= kNumOpenBlocks) {
+        CloseBlock(block - kNumOpenBlocks);
+      }
+      NodePtr begin = static_cast<NodePtr>(units_.size());
+      units_.resize(units_.size() + kBlockSize);
+      used_.resize(units_.size() / 64);
+      Block(block) = BlockInfo();
+      for (NodePtr i = begin; i < begin + kBlockSize; ++i) {
+        if (i != Null()) {  // Null marks an empty free list, so it is never linked
+          Link(i);
+        }
+      }
+    }
+  }
+
+  /// Appends a free unit to the tail of the free list
+  void Link(NodePtr index) {
+    AuxUnit& aux = Aux(index);
+    if (free_head_ == Null()) {
+      free_head_ = index;
+      aux.prev = index;
+      aux.next = index;
+    } else {
+      NodePtr tail = Aux(free_head_).prev;
+      aux.prev = tail;
+      aux.next = free_head_;
+      Aux(tail).next = index;
+      Aux(free_head_).prev = index;
+    }
+  }
+
+  void Unlink(NodePtr index) {
+    AuxUnit& aux = Aux(index);
+    if (aux.next == index) {
+      free_head_ = Null();
       return;
+    }
+    Aux(aux.prev).next = aux.next;
+    Aux(aux.next).prev = aux.prev;
+    if (free_head_ == index) {
+      free_head_ = aux.next;
+    }
+  }
 
-    units_.resize(size);
-    std::size_t old_size = auxes_.size();
-    auxes_.resize(size);
-    for (std::size_t i = old_size + 1; i < auxes_.size(); ++i) {
-      auxes_[i - 1].next = i;
-      auxes_[i].prev = i - 1;
+  /// Drops the free units of a block from the free list
+  void CloseBlock(NodePtr block) {
+    if (!IsOpen(block)) {
+      return;
     }
-    NodePtr old_tail = auxes_[free_head_].prev;
-    NodePtr new_tail = size - 1;
-    auxes_[old_tail].next = old_size;
-    auxes_[old_size].prev = old_tail;
-    auxes_[free_head_].prev = new_tail;
-    auxes_[new_tail].next = free_head_;
+    NodePtr begin = block * kBlockSize;
+    for (NodePtr i = begin; i < begin + kBlockSize; ++i) {
+      if (!IsUsed(i)) {
+        Unlink(i);
+      }
+    }
+    Block(block).closed = true;
   }
 
   void Reserve(NodePtr index) {
-    AuxUnit& aux = auxes_[index];
-    aux.used = true;
-    auxes_[aux.prev].next = aux.next;
-    auxes_[aux.next].prev = aux.prev;
+    Resize(index + 1);
+    used_[index / 64] |= static_cast<uint64_t>(1) << (index % 64);
+    if (index != Null() && IsOpen(index / kBlockSize)) {
+      Unlink(index);
+    }
+  }
+
+  /// Counts a failed Fetch attempt; a block failing too often is nearly full
+  void Reject(NodePtr index) {
+    NodePtr block = index / kBlockSize;
+    if (++Block(block).num_trials == kMaxTrials) {
+      closing_.push_back(block);
+    }
   }
 
   Char Label(NodePtr pid, std::size_t depth) {
@@ -294,10 +1621,60 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     return NullChar();
   }
 
+  /// The value index of the key kids_[pos]: its key id, or pos with dense ids
+  NodePtr ValueIndexOf(NodePtr pos) const {
+    return dense_ ? pos : kids_[pos];
+  }
+
+  /// Keeps the values of the distinct keys only, in the order of their dense ids
+  void CompactValues() {
+    ValueContainer values;
+    for (std::size_t i = 0; i < kids_.size(); ++i) {
+      values.push_back(values_[kids_[i]]);
+    }
+    values_ = values;
+  }
+
+  /// Records the value unit, or the flagged tail owner, of every dense id
+  void BuildLeaves() {
+    leaves_.clear();
+    leaves_.resize(values_.size(), Null());
+    for (NodePtr i = Root() + 1; i < units_.size(); ++i) {
+      const Node& unit = units_[i];
+      if (unit.check == Null()) {
+        continue;
+      }
+      if (units_[unit.check].base == i) {
+        leaves_[unit.GetValueIndex()] = i;
+      } else if (IsTail(unit.base)) {
+        leaves_[TailEndValueIndex(unit.base)] = i | TailFlag();
+      }
+    }
+  }
+
+  /// The value index after the tail at the flagged position pos
+  NodePtr TailEndValueIndex(NodePtr pos) const {
+    pos &= ~TailFlag();
+    while (tail_[pos] != NullChar()) {
+      ++pos;
+    }
+    return TailValueIndex(pos + 1);
+  }
+
+  /// Whether the keys kids_[begin, end) share a single suffix from depth on
+  bool IsTailRun(NodePtr begin, NodePtr end, std::size_t depth) const {
+    return tailing_ && end - begin == 1 && depth < keys_[kids_[begin]].length;
+  }
+
   void BuildNode(std::size_t depth, NodePtr parent, NodePtr begin, NodePtr end) {
     if (begin == end)
       return;
 
+    if (IsTailRun(begin, end, depth)) {
+      units_[parent].base = AppendTail(keys_[kids_[begin]], depth, ValueIndexOf(begin));
+      return;
+    }
+
     std::vector<Char> labels;
     std::vector<NodePtr> guards;
     for (NodePtr i = begin; i < end; ++i) {
@@ -309,69 +1686,526 @@ class DaTrie : public Trie<Char, Value, NodePtr> {
     }
     guards.push_back(end);
 
-    NodePtr base = Fetch(labels);
+    NodePtr base = Fetch(parent, labels);
     units_[parent].base = base;
     InsertUnits(parent, base, labels);
     bool final = false;
     if (labels[0] == NullChar()) {
       final = true;
-      NodePtr child = base + Index(labels[0]);
-      units_[child].SetValueIndex(kids_[begin]);  // store key id
+      NodePtr child = base + Code(labels[0]);
+      units_[child].SetValueIndex(ValueIndexOf(begin));
     }
 
     for (std::size_t i = final; i < labels.size(); ++i) {
-      NodePtr child = base + Index(labels[i]);
+      NodePtr child = base + Code(labels[i]);
       BuildNode(depth + 1, child, guards[i], guards[i + 1]);
     }
   }
 
-  NodePtr Fetch(const std::vector<Char>& labels) {
-    // Start at next of free_head_, so free_head_ will never be used
-    NodePtr free_idx = auxes_[free_head_].next;
-    while (free_idx != free_head_) {
-      NodePtr base = free_idx - Index(labels[0]);
-      bool fetched = true;
-      for (std::size_t i = 0; i < labels.size(); ++i) {
-        NodePtr p = base + Index(labels[i]);
-        if (p >= NumNodes()) {
-          break;
-        } else if (auxes_[p].used) {
-          fetched = false;
-          break;
+  void SortKids() {
+#if defined(_OPENMP) && defined(__GLIBCXX__)
+    if (parallel_) {
+      __gnu_parallel::sort(kids_.begin(), kids_.end(), KeyIdLess(keys_));
+      return;
+    }
+#endif
+    std::sort(kids_.begin(), kids_.end(), KeyIdLess(keys_));
+  }
+
+#if defined(_OPENMP)
+  /// A subtree is built as a trie of its keys whose values are the key ids
+  typedef DaTrie<Char, NodePtr, NodePtr> SubTrie;
+
+  /**
+   * Builds the subtree of each first label as a SubTrie on its own thread,
+   * then appends the subtries to units_ shifted by a constant offset. Only
+   * the first-level units, which are placed by the root, are not shifted.
+   */
+  void BuildSubtrees() {
+    std::vector<Char> labels;
+    std::vector<NodePtr> guards;
+    for (NodePtr i = 0; i < kids_.size(); ++i) {
+      Char label = Label(kids_[i], 0);
+      if (!labels.size() || labels.back() != label) {
+        labels.push_back(label);
+        guards.push_back(i);
+      }
+    }
+    guards.push_back(static_cast<NodePtr>(kids_.size()));
+    if (labels.empty()) {
+      return;
+    }
+    NodePtr base = Fetch(Root(), labels);
+    units_[Root()].base = base;
+    InsertUnits(Root(), base, labels);
+
+    long num_subtries = static_cast<long>(labels.size());
+    std::vector<SubTrie> subtries(labels.size());
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < num_subtries; ++i) {
+      if (IsTailRun(guards[static_cast<std::size_t>(i)],
+                    guards[static_cast<std::size_t>(i) + 1], 1)) {
+        continue;  // its tail hangs directly off the first-level unit
+      }
+      SubTrie& subtrie = subtries[static_cast<std::size_t>(i)];
+      subtrie.set_tail(tailing_);
+      subtrie.set_alphabet(remapped_);
+      subtrie.parent_alphabet_ = &CurrentAlphabet();
+      for (NodePtr j = guards[static_cast<std::size_t>(i)];
+          j < guards[static_cast<std::size_t>(i) + 1]; ++j) {
+        const Key& key = keys_[kids_[j]];
+        subtrie.DoInsert(key.begin, key.begin + key.length, ValueIndexOf(j));
+      }
+      subtrie.DoBuild(false);
+    }
+
+    // Units below kSubtrieBegin of a subtrie are Null and its root
+    std::vector<NodePtr> shifts(labels.size());
+    std::vector<NodePtr> tail_shifts(labels.size());
+    std::size_t size = units_.size();
+    std::size_t tail_size = tail_.size();
+    for (std::size_t i = 0; i < subtries.size(); ++i) {
+      if (subtries[i].units_.empty()) {
+        continue;
+      }
+      shifts[i] = static_cast<NodePtr>(size) - kSubtrieBegin;
+      size += subtries[i].units_.size() - kSubtrieBegin;
+      tail_shifts[i] = static_cast<NodePtr>(tail_size);
+      tail_size += subtries[i].tail_.size();
+    }
+    units_.resize(size);
+    tail_.resize(tail_size);
+    for (std::size_t i = 0; i < subtries.size(); ++i) {
+      if (subtries[i].units_.empty()) {
+        units_[base + Code(labels[i])].base = AppendTail(keys_[kids_[guards[i]]], 1,
+                                                          ValueIndexOf(guards[i]));
+      }
+    }
+#pragma omp parallel for schedule(dynamic)
+    for (long i = 0; i < num_subtries; ++i) {
+      std::size_t idx = static_cast<std::size_t>(i);
+      if (subtries[idx].units_.empty()) {
+        continue;
+      }
+      Relocate(subtries[idx], base + Code(labels[idx]), labels[idx], shifts[idx],
+               tail_shifts[idx]);
+      subtries[idx].Clear();
+    }
+  }
+
+  /// Copies the units of subtrie into units_, mapping its first-level unit to node
+  void Relocate(SubTrie& subtrie, NodePtr node, Char label, NodePtr shift, NodePtr tail_shift) {
+    for (std::size_t i = 0; i < subtrie.tail_.size(); ++i) {
+      tail_[tail_shift + i] = subtrie.tail_[i];
+    }
+    NodePtr top = subtrie.units_[subtrie.Root()].base + Code(label);
+    for (NodePtr i = kSubtrieBegin; i < subtrie.units_.size(); ++i) {
+      const typename SubTrie::Node& unit = subtrie.units_[i];
+      if (unit.check == Null() || i == top) {
+        continue;
+      }
+      Node& dst = units_[i + shift];
+      dst.check = (unit.check == top) ? node : unit.check + shift;
+      if (subtrie.units_[unit.check].base == i) {
+        dst.SetValueIndex(subtrie.values_[unit.GetValueIndex()]);  // terminal
+      } else {
+        dst.base = RelocateBase(subtrie, unit.base, shift, tail_shift);
+      }
+    }
+    units_[node].base = RelocateBase(subtrie, subtrie.units_[top].base, shift, tail_shift);
+  }
+
+  NodePtr RelocateBase(const SubTrie& subtrie, NodePtr base, NodePtr shift, NodePtr tail_shift) {
+    if (!IsTail(base)) {
+      return base + shift;
+    }
+    // the value index after the tail is a subtrie key id
+    NodePtr pos = (base & ~TailFlag()) + tail_shift;
+    while (tail_[pos] != NullChar()) {
+      ++pos;
+    }
+    NodePtr kid = subtrie.values_[TailValueIndex(pos + 1)];
+    std::memcpy(&tail_[pos + 1], &kid, sizeof(NodePtr));
+    return base + tail_shift;
+  }
+#endif
+
+  bool IsVacant(NodePtr base, const std::vector<Char>& labels) const {
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      NodePtr p = base + Code(labels[i]);
+      if (p < units_.size() && IsUsed(p)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Finds a base whose child units for labels are all free.
+   * A base is never Null or Root, whose unit would pass for the value unit of
+   * the node (the root is its own check).
+   * Only the free units of open blocks are visited, so the cost of a Fetch is
+   * bounded by the window size rather than by the size of the array.
+   */
+  NodePtr Fetch(NodePtr parent, const std::vector<Char>& labels) {
+    NodePtr first = Code(labels[0]);
+    for (std::size_t i = 1; i < labels.size(); ++i) {
+      first = std::min(first, Code(labels[i]));
+    }
+    NodePtr base = Null();
+    if (free_head_ != Null()) {
+      NodePtr free_idx = free_head_;
+      do {
+        if (free_idx > first + Root() && IsValidBase(parent, free_idx - first)) {
+          if (IsVacant(free_idx - first, labels)) {
+            base = free_idx - first;
+            break;
+          }
+          Reject(free_idx);
         }
+        free_idx = Aux(free_idx).next;
+      } while (free_idx != free_head_);
+    }
+    for (std::size_t i = 0; i < closing_.size(); ++i) {
+      CloseBlock(closing_[i]);
+    }
+    closing_.clear();
+    if (base == Null()) {
+      // every unit past the end is free
+      base = units_.size() > first + Root() ? static_cast<NodePtr>(units_.size()) - first
+          : Root() + 1;
+      while (!IsValidBase(parent, base)) {
+        ++base;
       }
-      if (fetched) {
-        return base;
+    }
+    if (packing_) {
+      if (base / 64 >= bases_.size()) {
+        bases_.resize(base / 64 + 1);
       }
-      free_idx = auxes_[free_idx].next;
+      bases_[base / 64] |= static_cast<uint64_t>(1) << (base % 64);
+    }
+    return base;
+  }
+
+  /// While packing, a base must be unused and its offset packable
+  bool IsValidBase(NodePtr parent, NodePtr base) const {
+    if (!packing_) {
+      return true;
     }
-    return NumNodes() - Index(labels[0]);
+    bool used = base / 64 < bases_.size() && ((bases_[base / 64] >> (base % 64)) & 1);
+    return !used && IsPackableOffset(base ^ parent);
   }
 
   void InsertUnits(NodePtr parent, NodePtr base, const std::vector<Char>& labels) {
     if (!labels.size())
       return;
-    NodePtr max_idx = base + Index(labels.back());
+    NodePtr max_idx = base;
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      max_idx = std::max(max_idx, base + Code(labels[i]));
+    }
     Resize(max_idx + 1);
     for (std::size_t i = 0; i < labels.size(); ++i) {
-      NodePtr idx = base + Index(labels[i]);
+      NodePtr idx = base + Code(labels[i]);
       Node& unit = Unit(idx);
       Reserve(idx);
       unit.check = parent;
     }
   }
 
+  /**
+   * Prepares the built trie for in-place updates.
+   * The free-space tracker is rebuilt from the checks and covers every block
+   * from then on, so that units freed by Erase can be reused. Mapped arrays
+   * are copied into owned storage.
+   */
+  void Thaw() {
+    if (dynamic_) {
+      return;
+    }
+    DetachArrays();
+    // the parallel build leaves a partial last block
+    units_.resize((units_.size() + kBlockSize - 1) / kBlockSize * kBlockSize);
+    dynamic_ = true;
+    packing_ = false;
+    used_.assign(units_.size() / 64, 0);
+    auxes_.assign(units_.size(), AuxUnit());
+    blocks_.assign(NumBlocks(), BlockInfo());
+    free_head_ = Null();
+    for (NodePtr i = 0; i < units_.size(); ++i) {
+      if (i == Null() || i == Root() || units_[i].check != Null()) {
+        used_[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+      } else {
+        Link(i);
+      }
+    }
+  }
+
+  /// Copies the arrays mapped by Open into owned storage
+  void DetachArrays() {
+    units_.Detach();
+    values_.Detach();
+    tail_.Detach();
+    leaves_.Detach();
+  }
+
+  /// Returns a unit to the free list, reopening its block if it was closed
+  void Free(NodePtr index) {
+    units_[index] = Node();
+    used_[index / 64] &= ~(static_cast<uint64_t>(1) << (index % 64));
+    NodePtr block = index / kBlockSize;
+    if (!Block(block).closed) {
+      Link(index);
+      return;
+    }
+    Block(block) = BlockInfo();
+    NodePtr begin = block * kBlockSize;
+    for (NodePtr i = begin; i < begin + kBlockSize; ++i) {
+      if (!IsUsed(i)) {
+        Link(i);
+      }
+    }
+  }
+
+  /// Appends the labels of the children of node in order, probing every code in use
+  void ChildLabels(NodePtr node, std::vector<Char>* labels) const {
+    NodePtr base = units_[node].base;
+    if (base == Null() || IsTail(base)) {
+      return;
+    }
+    std::size_t first = static_cast<std::size_t>(base) + FirstCode();
+    std::size_t end = std::min(units_.size(), static_cast<std::size_t>(base) + NumCodes());
+    for (std::size_t i = base; i < end; i = std::max(i + 1, first)) {
+      if (i != Root() && units_[i].check == node) {
+        labels->push_back(LabelOf(static_cast<NodePtr>(i - base)));
+      }
+    }
+  }
+
+  /**
+   * Returns the child of parent for label, adding it if needed.
+   * If its unit is taken by a child of another node, the node with fewer
+   * children has them moved to a new base.
+   */
+  NodePtr AddChild(NodePtr parent, Char label) {
+    if (!remapped_) {
+      AddCode(Code(label));
+    }
+    NodePtr base = units_[parent].base;
+    NodePtr child = base + Code(label);
+    if (base != Null()) {
+      if (child < units_.size() && units_[child].check == parent) {
+        return child;
+      }
+      if (child >= units_.size() || !IsUsed(child)) {
+        Reserve(child);
+        units_[child].check = parent;
+        return child;
+      }
+    }
+    std::vector<Char> labels;
+    ChildLabels(parent, &labels);
+    std::vector<Char> owner_labels;
+    NodePtr owner = Null();
+    if (base != Null() && child != Root()) {
+      owner = units_[child].check;
+      ChildLabels(owner, &owner_labels);
+    }
+    if (owner != Null() && owner_labels.size() <= labels.size()) {
+      MoveChildren(owner, owner_labels, Fetch(owner, owner_labels), &parent);
+    } else {
+      std::vector<Char> new_labels(labels);
+      new_labels.push_back(label);
+      MoveChildren(parent, labels, Fetch(parent, new_labels), &parent);
+      child = units_[parent].base + Code(label);
+    }
+    Reserve(child);
+    units_[child].check = parent;
+    return child;
+  }
+
+  /// Moves the children of node to new_base, updating *tracked if it moves
+  void MoveChildren(NodePtr node, const std::vector<Char>& labels, NodePtr new_base,
+                    NodePtr* tracked) {
+    NodePtr old_base = units_[node].base;
+    std::vector<Char> kids;
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      NodePtr from = old_base + Code(labels[i]);
+      NodePtr to = new_base + Code(labels[i]);
+      Reserve(to);
+      units_[to] = units_[from];
+      if (dense_ && labels[i] == NullChar()) {
+        leaves_[units_[to].GetValueIndex()] = to;
+      } else if (dense_ && IsTail(units_[to].base)) {
+        leaves_[TailEndValueIndex(units_[to].base)] = to | TailFlag();
+      }
+      if (labels[i] != NullChar()) {  // a terminal's base is a value index
+        kids.clear();
+        ChildLabels(from, &kids);
+        for (std::size_t j = 0; j < kids.size(); ++j) {
+          units_[units_[from].base + Code(kids[j])].check = to;
+        }
+      }
+      Free(from);
+      if (*tracked == from) {
+        *tracked = to;
+      }
+    }
+    units_[node].base = new_base;
+  }
+
+  /// Replaces the tail hanging off node by a chain of units
+  void ExpandTail(NodePtr node) {
+    NodePtr pos = units_[node].base & ~TailFlag();
+    units_[node].base = Null();
+    for (; tail_[pos] != NullChar(); ++pos) {
+      node = AddChild(node, tail_[pos]);
+    }
+    NodePtr leaf = AddChild(node, NullChar());
+    units_[leaf].SetValueIndex(TailValueIndex(pos + 1));
+    if (dense_) {
+      leaves_[TailValueIndex(pos + 1)] = leaf;
+    }
+  }
+
+  /// Frees node and its ancestors up to the first one with another child
+  void Prune(NodePtr node) {
+    std::vector<Char> labels;
+    while (node != Root() && !IsTail(units_[node].base)) {
+      ChildLabels(node, &labels);
+      if (!labels.empty()) {
+        break;
+      }
+      NodePtr parent = units_[node].check;
+      Free(node);
+      node = parent;
+    }
+  }
+
+  static FileHeader MakeHeader() {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "BALGODA", 8);
+    header.version = kFileVersion;
+    header.char_size = sizeof(Char);
+    header.value_size = sizeof(Value);
+    header.node_ptr_size = sizeof(NodePtr);
+    header.node_size = sizeof(Node);
+    return header;
+  }
+
+  static uint64_t AlignOffset(uint64_t offset) {
+    return (offset + kFileAlignment - 1) / kFileAlignment * kFileAlignment;
+  }
+
+  template<typename T>
+  static FileBlob Blob(uint32_t id, const MappableVector<T>& vec) {
+    FileBlob blob;
+    blob.id = id;
+    blob.elem_size = sizeof(T);
+    blob.data = reinterpret_cast<const char*>(vec.data());
+    blob.count = vec.size();
+    return blob;
+  }
+
+  static bool WriteFile(const std::string& path, const std::vector<FileBlob>& blobs) {
+    FileHeader header = MakeHeader();
+    header.num_sections = static_cast<uint32_t>(blobs.size());
+    std::vector<FileSection> sections(blobs.size());
+    uint64_t offset = AlignOffset(sizeof(FileHeader) + sizeof(FileSection) * blobs.size());
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+      sections[i].id = blobs[i].id;
+      sections[i].elem_size = blobs[i].elem_size;
+      sections[i].offset = offset;
+      sections[i].count = blobs[i].count;
+      offset = AlignOffset(offset + blobs[i].elem_size * blobs[i].count);
+    }
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!sections.empty()) {
+      out.write(reinterpret_cast<const char*>(&sections[0]),
+                static_cast<std::streamsize>(sizeof(FileSection) * sections.size()));
+    }
+    uint64_t pos = sizeof(FileHeader) + sizeof(FileSection) * sections.size();
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+      for (; pos < sections[i].offset; ++pos) {
+        out.put(0);
+      }
+      uint64_t bytes = blobs[i].elem_size * blobs[i].count;
+      if (bytes) {
+        out.write(blobs[i].data, static_cast<std::streamsize>(bytes));
+      }
+      pos += bytes;
+    }
+    out.close();
+    return !out.fail();
+  }
+
+  static bool ReadHeader(const MappedFile& file) {
+    FileHeader expected = MakeHeader();
+    if (file.size() < sizeof(FileHeader)) {
+      return false;
+    }
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(file.data());
+    expected.num_sections = header->num_sections;
+    return std::memcmp(header, &expected, sizeof(FileHeader)) == 0
+        && file.size() >= sizeof(FileHeader) + sizeof(FileSection) * header->num_sections;
+  }
+
+  /// Returns the section id if it is present and fits in the file
+  static const FileSection* FindSection(const MappedFile& file, uint32_t id, uint32_t elem_size) {
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(file.data());
+    const FileSection* sections = reinterpret_cast<const FileSection*>(header + 1);
+    for (uint32_t i = 0; i < header->num_sections; ++i) {
+      const FileSection& section = sections[i];
+      if (section.id != id) {
+        continue;
+      }
+      if (section.elem_size != elem_size || section.offset % kFileAlignment
+          || section.offset > file.size()
+          || section.count > (file.size() - section.offset) / elem_size) {
+        return NULL;
+      }
+      return &section;
+    }
+    return NULL;
+  }
+
   std::string NodeString(NodePtr node) const {
     return units_[node].ToString();
   }
 
   NodeContainer units_;
+  PackedContainer packed_units_;  ///< Replaces units_ in the packed layout
   ValueContainer values_;
   KidContainer kids_;
+  bool packed_;    ///< Pack the next Build
+  bool packing_;   ///< The current Build is packing
+  bool parallel_;  ///< Build in parallel
+  bool tail_enabled_;  ///< Use tails in the next Build
+  bool tailing_;       ///< The current Build uses tails
+  bool dynamic_;       ///< Updated in place since Build, see Thaw
+  bool dense_ids_;      ///< Dense ids in the next Build, see set_dense_ids
+  bool dense_;          ///< The current trie has dense ids
+  bool remap_;          ///< Remap the labels in the next Build, see set_alphabet
+  bool remapped_;       ///< The current trie places children by their codes
+  AlphabetType alphabet_;  ///< Codes of the labels when remapped_
+  const AlphabetType* parent_alphabet_;  ///< The alphabet of a trie this subtrie is built for
+  NodePtr code_begin_;  ///< Smallest raw code of a child but NullChar's, when not remapped_
+  NodePtr code_end_;    ///< One past the largest raw code of a child, when not remapped_
+  TailContainer tail_;  ///< Suffixes of single-key subtrees
+  LeafContainer leaves_;  ///< Value unit of each dense id, or the flagged owner of its tail
+  std::size_t peak_bytes_;  ///< Peak allocation of the last Build
 
+  // Build-only structures, released at the end of Build; the free-space
+  // ones are rebuilt by Thaw for updates
   KeyContainer keys_;
-  NodePtr free_head_;
-  AuxContainer auxes_;
+  BitContainer used_;        ///< Bitmap of used units
+  BitContainer bases_;       ///< Bitmap of used bases, only while packing
+  NodePtr free_head_;        ///< First unit of the free list, Null if empty
+  AuxContainer auxes_;       ///< Free list links of the open blocks
+  BlockContainer blocks_;    ///< Free-space state of the open blocks
+  std::vector<NodePtr> closing_;  ///< Blocks to close after the current Fetch
 };
 
 }  // namespace balgo
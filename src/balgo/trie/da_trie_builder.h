@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_DA_TRIE_BUILDER_H_
+#define BALGO_TRIE_DA_TRIE_BUILDER_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "da_trie.h"
+
+namespace balgo {
+
+/**
+ * @brief Streaming builder of a DaTrie from sorted keys
+ *
+ * Keys are added in ascending order of their unsigned chars, and the units of
+ * a node are placed as soon as the next key leaves its subtree. Only the last
+ * key and the nodes on its path are kept aside from the trie itself, so the
+ * keys do not have to stay in memory and the peak memory is close to the
+ * size of the result. A unit is written before its parent is placed, so its
+ * check is patched once the parent gets its index.
+ *
+ * @note Usage:
+ * 1) DaTrieBuilder builder(&trie)
+ * 2) Add, AddKeys or AddFile
+ * 3) Finish
+ *
+ * The trie gets the plain layout without tails and can be updated afterwards.
+ * With set_dense_ids, the value index of a key is its ordinal among the keys.
+ */
+template<typename Char = char, typename Value = uint32_t, typename NodePtr = uint32_t>
+class DaTrieBuilder {
+ public:
+  typedef DaTrie<Char, Value, NodePtr> TrieType;
+
+  /// Clears trie, which is filled by the following Adds and built by Finish
+  explicit DaTrieBuilder(TrieType* trie)
+      : trie_(trie),
+        num_keys_(0) {
+    trie_->Clear();
+    trie_->packing_ = false;
+    trie_->tailing_ = false;
+    trie_->InitUnits();
+    levels_.resize(1);
+  }
+
+  /**
+   * Adds a key greater than the previous one.
+   * @return false if the key is empty, a duplicate or out of order
+   */
+  bool Add(const Char* begin, const Char* end, const Value& value) {
+    if (begin == end || trie_->IsBuilt()) {
+      return false;
+    }
+    std::size_t length = static_cast<std::size_t>(end - begin);
+    std::size_t common = 0;
+    while (common < length && common < last_.size() && last_[common] == begin[common]) {
+      ++common;
+    }
+    if (num_keys_ && (common == length || (common < last_.size()
+        && TrieType::Index(begin[common]) < TrieType::Index(last_[common])))) {
+      return false;
+    }
+    Close(common);
+    last_.assign(begin, end);
+    levels_.resize(length + 1);
+    AddChild(length, NullChar(), static_cast<NodePtr>(trie_->values_.size()));
+    trie_->values_.push_back(value);
+    ++num_keys_;
+    return true;
+  }
+
+  bool Add(const Char* begin, std::size_t length, const Value& value) {
+    return Add(begin, begin + length, value);
+  }
+
+  bool Add(const Char* begin, const Value& value) {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return Add(begin, begin + length, value);
+  }
+
+  /**
+   * Adds the sorted strings [first, last), each valued by its ordinal among
+   * the keys added so far.
+   * @return false if some key is rejected by Add
+   */
+  template<typename Iterator>
+  bool AddKeys(Iterator first, Iterator last) {
+    bool ok = true;
+    for (; first != last; ++first) {
+      const std::basic_string<Char>& key = *first;
+      ok &= Add(key.data(), key.size(), static_cast<Value>(num_keys_));
+    }
+    return ok;
+  }
+
+  /**
+   * Adds the sorted lines of a file, each valued by its ordinal among the
+   * keys added so far. Lines are read one at a time.
+   * @return false if the file cannot be read or some key is rejected by Add
+   */
+  bool AddFile(const std::string& path) {
+    std::basic_ifstream<Char> in(path.c_str());
+    if (!in) {
+      return false;
+    }
+    bool ok = true;
+    std::basic_string<Char> line;
+    while (std::getline(in, line)) {
+      ok &= Add(line.data(), line.size(), static_cast<Value>(num_keys_));
+    }
+    return ok && in.eof();
+  }
+
+  /// Places the remaining nodes and marks the trie built
+  void Finish() {
+    if (trie_->IsBuilt()) {
+      return;
+    }
+    Close(0);
+    Level& root = levels_[0];
+    if (!root.labels.empty()) {
+      NodePtr base = Place(root);
+      trie_->units_[trie_->Root()].base = base;
+      Adopt(trie_->Root(), base, root.labels);
+    }
+    std::vector<Level>().swap(levels_);
+    std::vector<Char>().swap(last_);
+    if (trie_->dense_ids_) {
+      // values are in key order, one per key, so value indexes are dense ids
+      trie_->dense_ = true;
+      trie_->BuildLeaves();
+    }
+    trie_->UpdatePeak();
+    trie_->ReleaseBuild();
+    trie_->MarkBuilt();
+  }
+
+  std::size_t num_keys() const {
+    return num_keys_;
+  }
+
+ private:
+  /// Children of a node on the path of the last key, placed or not
+  struct Level {
+    std::vector<Char> labels;
+    std::vector<NodePtr> bases;  ///< Bases of the placed children, value indexes of leaves
+    std::vector<std::vector<Char> > kid_labels;  ///< Labels of the placed children's children
+  };
+
+  static Char NullChar() {
+    return TrieType::NullChar();
+  }
+
+  void AddChild(std::size_t depth, Char label, NodePtr base) {
+    Level& level = levels_[depth];
+    trie_->AddCode(trie_->Code(label));
+    level.labels.push_back(label);
+    level.bases.push_back(base);
+    level.kid_labels.push_back(std::vector<Char>());
+  }
+
+  /// Places the nodes on the path of the last key deeper than depth
+  void Close(std::size_t depth) {
+    while (levels_.size() > depth + 1) {
+      Level& level = levels_.back();
+      NodePtr base = Place(level);
+      std::vector<Char> labels;
+      labels.swap(level.labels);
+      levels_.pop_back();
+      Level& parent = levels_.back();
+      AddChild(levels_.size() - 1, last_[levels_.size() - 1], base);
+      parent.kid_labels.back().swap(labels);
+    }
+  }
+
+  /// Writes the children of a node at a fetched base, pending their checks
+  NodePtr Place(const Level& level) {
+    NodePtr base = trie_->Fetch(trie_->Null(), level.labels);
+    trie_->InsertUnits(trie_->Null(), base, level.labels);
+    for (std::size_t i = 0; i < level.labels.size(); ++i) {
+      NodePtr child = base + TrieType::Index(level.labels[i]);
+      trie_->units_[child].base = level.bases[i];
+      Adopt(child, level.bases[i], level.kid_labels[i]);
+    }
+    return base;
+  }
+
+  /// Sets the checks of the children of node now that its index is known
+  void Adopt(NodePtr node, NodePtr base, const std::vector<Char>& labels) {
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      trie_->units_[base + TrieType::Index(labels[i])].check = node;
+    }
+  }
+
+  TrieType* trie_;
+  std::size_t num_keys_;
+  std::vector<Char> last_;     ///< Last key added
+  std::vector<Level> levels_;  ///< Children of the nodes on the path of last_, by depth
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_DA_TRIE_BUILDER_H_
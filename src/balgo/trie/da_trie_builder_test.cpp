@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "trie_test_common.h"
+#include "da_trie_builder.h"
+
+namespace balgo {
+
+TEST(DaTrieBuilder, Add) {
+  const char * kPatterns[] = { "a", "abc", "abcde", "bc" };
+  DaTrie<char, size_t> trie;
+  DaTrieBuilder<char, size_t> builder(&trie);
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    EXPECT_TRUE(builder.Add(kPatterns[i], i));
+  }
+  EXPECT_FALSE(builder.Add("bc", 9));
+  EXPECT_FALSE(builder.Add("abd", 9));
+  EXPECT_FALSE(builder.Add("b", 9));
+  EXPECT_FALSE(builder.Add("", 9));
+  EXPECT_EQ(4U, builder.num_keys());
+  EXPECT_FALSE(trie.IsBuilt());
+  builder.Finish();
+  EXPECT_TRUE(trie.IsBuilt());
+  EXPECT_FALSE(builder.Add("bcd", 9));
+
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    size_t value = 9999;
+    EXPECT_TRUE(trie.Match(kPatterns[i], &value));
+    EXPECT_EQ(i, value);
+  }
+  const char * kNonPatterns[] = { "", "ab", "abd", "b", "bcd", "abcdefabc" };
+  for (size_t i = 0; i < ARRAY_SIZE(kNonPatterns); ++i) {
+    EXPECT_FALSE(trie.Match(kNonPatterns[i])) << " non-pattern: " << kNonPatterns[i];
+  }
+  EXPECT_EQ(3U, trie.MatchPrefix("abcdefgh"));
+
+  // the result can be updated like a trie from Build
+  EXPECT_TRUE(trie.Insert("ab", 4));
+  EXPECT_TRUE(trie.Erase("abc"));
+  EXPECT_TRUE(trie.Match("ab"));
+  EXPECT_FALSE(trie.Match("abc"));
+  EXPECT_TRUE(trie.Match("abcde"));
+}
+
+TEST(DaTrieBuilder, Empty) {
+  DaTrie<char, size_t> trie;
+  trie.Insert("abc", 1);
+  DaTrieBuilder<char, size_t> builder(&trie);
+  builder.Finish();
+  EXPECT_TRUE(trie.IsBuilt());
+  EXPECT_FALSE(trie.Match("abc"));
+  EXPECT_EQ(0U, trie.MatchPrefix("abc"));
+}
+
+TEST(DaTrieBuilder, AddKeys) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  DaTrie<char, size_t> trie;
+  DaTrieBuilder<char, size_t> builder(&trie);
+  EXPECT_TRUE(builder.AddKeys(keys.begin(), keys.end()));
+  builder.Finish();
+
+  DaTrie<char, size_t> built;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    built.Insert(keys[i].c_str(), i);
+  }
+  built.Build();
+  EXPECT_LE(trie.NumNodes(), built.NumNodes() + built.NumNodes() / 10);
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 9999;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(i, value);
+  }
+  std::vector<std::string> others = GenerateKeys(20000, 2);
+  for (size_t i = 0; i < others.size(); ++i) {
+    EXPECT_EQ(built.Match(others[i].c_str()), trie.Match(others[i].c_str()))
+        << " key: " << others[i];
+    EXPECT_EQ(built.MatchPrefix(others[i].c_str()), trie.MatchPrefix(others[i].c_str()))
+        << " key: " << others[i];
+  }
+}
+
+TEST(DaTrieBuilder, DenseIds) {
+  std::vector<std::string> keys = GenerateKeys(1000);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  DaTrie<char, size_t> trie;
+  trie.set_dense_ids(true);
+  DaTrieBuilder<char, size_t> builder(&trie);
+  EXPECT_TRUE(builder.AddKeys(keys.begin(), keys.end()));
+  builder.Finish();
+  ASSERT_EQ(keys.size(), trie.NumKeys());
+  std::string key;
+  for (uint32_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.KeyOf(i, &key)) << " id: " << i;
+    EXPECT_EQ(keys[i], key);
+    uint32_t id = 0;
+    EXPECT_TRUE(trie.IdOf(keys[i].c_str(), &id));
+    EXPECT_EQ(i, id);
+  }
+}
+
+TEST(DaTrieBuilder, AddFile) {
+  std::vector<std::string> keys = GenerateKeys(1000);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::string path = testing::TempDir() + "da_trie_builder_test.txt";
+  std::ofstream out(path.c_str());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    out << keys[i] << "\n";
+  }
+  out.close();
+
+  DaTrie<char, size_t> trie;
+  DaTrieBuilder<char, size_t> builder(&trie);
+  EXPECT_TRUE(builder.AddFile(path));
+  EXPECT_FALSE(builder.AddFile(path + ".missing"));
+  builder.Finish();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 9999;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(i, value);
+  }
+
+  // unsorted lines are skipped
+  std::reverse(keys.begin(), keys.end());
+  out.open(path.c_str());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    out << keys[i] << "\n";
+  }
+  out.close();
+  DaTrieBuilder<char, size_t> unsorted(&trie);
+  EXPECT_FALSE(unsorted.AddFile(path));
+  EXPECT_EQ(1U, unsorted.num_keys());
+  std::remove(path.c_str());
+}
+
+}  // namespace balgo
@@ -23,6 +23,12 @@
  * @date		2013-8-16
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "trie_test_common.h"
@@ -30,6 +36,134 @@
 
 namespace balgo {
 
+/// Compares MatchBatch on a trie built from GenerateKeys with Match
+void TestMatchBatch(DaTrie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+
+  std::vector<std::string> queries = GenerateKeys(1000, 2);
+  queries.insert(queries.end(), keys.begin(), keys.begin() + 1000);
+  queries.push_back("");
+  std::vector<const char*> ptrs;
+  std::vector<size_t> lengths;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    ptrs.push_back(queries[i].c_str());
+    lengths.push_back(queries[i].size());
+  }
+  std::vector<size_t> values(queries.size(), 9999);
+  bool* found = new bool[queries.size()];
+  size_t cnt = trie.MatchBatch(&ptrs[0], &lengths[0], queries.size(), &values[0], found);
+  size_t expected_cnt = 0;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    size_t value = 9999;
+    bool expected = trie.Match(queries[i].c_str(), &value);
+    expected_cnt += expected;
+    ASSERT_EQ(expected, found[i]) << " key: " << queries[i];
+    if (expected) {
+      EXPECT_EQ(value, values[i]) << " key: " << queries[i];
+    }
+  }
+  EXPECT_EQ(expected_cnt, cnt);
+  EXPECT_LT(1000U, cnt);
+
+  std::vector<size_t> cstr_values(queries.size(), 9999);
+  EXPECT_EQ(cnt, trie.MatchBatch(&ptrs[0], queries.size(), &cstr_values[0], NULL));
+  for (size_t i = 0; i < queries.size(); ++i) {
+    if (found[i]) {
+      EXPECT_EQ(values[i], cstr_values[i]) << " key: " << queries[i];
+    }
+  }
+  EXPECT_EQ(cnt, trie.MatchBatch(&ptrs[0], &lengths[0], queries.size(), NULL, NULL));
+  delete[] found;
+}
+
+/// Compares PredictiveSearch on a trie built from GenerateKeys with the sorted keys
+void TestPredictiveSearch(DaTrie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  std::vector<std::string> sorted(keys);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+  const char * kPrefixes[] = { "", "a", "ab", "abc", "abca", "zz", "zzzzzzzzzzzzz" };
+  std::vector<std::string> prefixes(kPrefixes, kPrefixes + ARRAY_SIZE(kPrefixes));
+  prefixes.insert(prefixes.end(), keys.begin(), keys.begin() + 100);
+  DaTrie<char, size_t>::Cursor cursor;
+  for (size_t i = 0; i < prefixes.size(); ++i) {
+    const std::string& prefix = prefixes[i];
+    std::vector<std::string>::iterator it = std::lower_bound(sorted.begin(), sorted.end(), prefix);
+    trie.PredictiveSearch(prefix.data(), prefix.data() + prefix.size(), &cursor);
+    for (; it != sorted.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+      ASSERT_TRUE(cursor.Next()) << " prefix: " << prefix << ", expected: " << *it;
+      ASSERT_EQ(*it, cursor.key()) << " prefix: " << prefix;
+      EXPECT_EQ(*it, keys[cursor.value()]);
+    }
+    EXPECT_FALSE(cursor.Next()) << " prefix: " << prefix << ", got: " << cursor.key();
+    EXPECT_FALSE(cursor.Next());
+  }
+}
+
+/// Checks the dense ids of a trie built from GenerateKeys, then updates it
+void TestDenseIds(DaTrie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  trie.Clear();
+  trie.set_dense_ids(true);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  std::vector<std::string> sorted(keys);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  ASSERT_EQ(sorted.size(), trie.NumKeys());
+
+  std::string key;
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    uint32_t id = 0;
+    ASSERT_TRUE(trie.IdOf(sorted[i].c_str(), &id)) << " key: " << sorted[i];
+    EXPECT_EQ(i, id);
+    ASSERT_TRUE(trie.KeyOf(i, &key)) << " id: " << i;
+    EXPECT_EQ(sorted[i], key);
+    size_t value = 9999;
+    ASSERT_TRUE(trie.Match(sorted[i].c_str(), &value));
+    EXPECT_EQ(sorted[i], keys[value]);
+  }
+  uint32_t id = 0;
+  EXPECT_FALSE(trie.IdOf("abcdefghijklmn", &id));
+  EXPECT_FALSE(trie.KeyOf(static_cast<uint32_t>(sorted.size()), &key));
+
+  // updates take new ids and leave holes
+  std::vector<std::string> others = GenerateKeys(2000, 2);
+  for (size_t i = 0; i < others.size(); ++i) {
+    if (!trie.Match(others[i].c_str())) {
+      ASSERT_TRUE(trie.Insert(others[i].c_str(), i));
+      ASSERT_TRUE(trie.IdOf(others[i].c_str(), &id));
+      EXPECT_EQ(trie.NumKeys() - 1, id);
+      sorted.push_back(others[i]);
+    }
+  }
+  for (size_t i = 0; i < sorted.size(); i += 3) {
+    EXPECT_TRUE(trie.Erase(sorted[i].c_str()));
+  }
+  ASSERT_EQ(sorted.size(), trie.NumKeys());
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    if (i % 3 == 0) {
+      EXPECT_FALSE(trie.KeyOf(i, &key)) << " id: " << i;
+    } else {
+      ASSERT_TRUE(trie.KeyOf(i, &key)) << " id: " << i;
+      EXPECT_EQ(sorted[i], key);
+    }
+  }
+}
+
 TEST(DaTrie, Match) {
   DaTrie<char, size_t> trie;
   TestMatch(trie);
@@ -40,4 +174,665 @@ TEST(DaTrie, MatchPrefix) {
   TestMatchPrefix(trie);
 }
 
+TEST(DaTrie, MatchPrefixVisitor) {
+  DaTrie<char, size_t> trie;
+  TestMatchPrefixVisitor(trie);
+}
+
+TEST(DaTrie, Segment) {
+  DaTrie<char, size_t> trie;
+  TestSegment(trie);
+}
+
+TEST(DaTrie, ManyKeys) {
+  DaTrie<char, size_t> trie;
+  TestManyKeys(trie);
+}
+
+/// Exposes the units of the root's children
+class LayoutDaTrie : public DaTrie<char, size_t> {
+ public:
+  uint32_t RootChild(char label) const {
+    return Child(Root(), label);
+  }
+};
+
+TEST(DaTrie, Layout) {
+  // the free list starts in the first block, so the root's children are
+  // placed there and its holes are reused
+  std::vector<std::string> keys = GenerateKeys(20000);
+  LayoutDaTrie trie;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    uint32_t child = trie.RootChild(keys[i][0]);
+    EXPECT_GT(child, 1U) << " key: " << keys[i];
+    EXPECT_LT(child, 256U + 256U) << " key: " << keys[i];
+  }
+  EXPECT_EQ(0U, trie.RootChild('A'));
+  EXPECT_GT(trie.MemoryUsage().fill_ratio, 0.99);
+}
+
+TEST(DaTrie, Packed) {
+  DaTrie<char, size_t> trie;
+  trie.set_packed(true);
+  TestMatch(trie);
+  EXPECT_EQ(4U, trie.NodeSize());
+  TestMatchPrefix(trie);
+  TestManyKeys(trie);
+  EXPECT_EQ(4U, trie.NodeSize());
+  EXPECT_NE(std::string::npos, trie.StatsString().find("unpacked_size="));
+
+  std::string path = testing::TempDir() + "da_trie_test_packed.da";
+  ASSERT_TRUE(trie.Save(path));
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  EXPECT_EQ(4U, mapped.NodeSize());
+  EXPECT_EQ(trie.NumNodes(), mapped.NumNodes());
+  std::vector<std::string> keys = GenerateKeys(20000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 9999;
+    ASSERT_TRUE(mapped.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(keys[i], keys[value]);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, Parallel) {
+  DaTrie<char, size_t> trie;
+  trie.set_parallel(true);
+  TestMatch(trie);
+  TestMatchPrefix(trie);
+  TestManyKeys(trie);
+
+  DaTrie<char, size_t> serial;
+  std::vector<std::string> keys = GenerateKeys(20000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    serial.Insert(keys[i].c_str(), i);
+  }
+  serial.Build();
+  std::vector<std::string> queries = GenerateKeys(20000, 3);
+  queries.insert(queries.end(), keys.begin(), keys.end());
+  // duplicate keys may keep different values, so compare the matched keys
+  for (size_t i = 0; i < queries.size(); ++i) {
+    size_t expected = 0;
+    size_t value = 0;
+    EXPECT_EQ(serial.Match(queries[i].c_str(), &expected), trie.Match(queries[i].c_str(), &value));
+    EXPECT_EQ(keys[expected], keys[value]);
+    std::vector<size_t> expected_values;
+    std::vector<size_t> values;
+    serial.MatchPrefix(queries[i].c_str(), &expected_values);
+    trie.MatchPrefix(queries[i].c_str(), &values);
+    ASSERT_EQ(expected_values.size(), values.size());
+    for (size_t j = 0; j < values.size(); ++j) {
+      EXPECT_EQ(keys[expected_values[j]], keys[values[j]]);
+    }
+  }
+}
+
+TEST(DaTrie, Tail) {
+  DaTrie<char, size_t> trie;
+  trie.set_tail(true);
+  TestMatch(trie);
+  TestMatchPrefix(trie);
+  TestManyKeys(trie);
+
+  const char * kUrls[] = { "http://example.com/index.html", "http://example.com/about.html",
+      "http://example.org/", "https://example.com/" };
+  DaTrie<char, size_t> plain;
+  trie.Clear();
+  for (size_t i = 0; i < ARRAY_SIZE(kUrls); ++i) {
+    trie.Insert(kUrls[i], i);
+    plain.Insert(kUrls[i], i);
+  }
+  std::vector<std::string> urls;
+  for (size_t i = 0; i < 1000; ++i) {
+    std::stringstream ss;
+    ss << "http://www.example" << i % 37 << ".com/articles/" << i * 7919 << "/index.html";
+    urls.push_back(ss.str());
+    trie.Insert(urls.back().c_str(), ARRAY_SIZE(kUrls) + i);
+    plain.Insert(urls.back().c_str(), ARRAY_SIZE(kUrls) + i);
+  }
+  trie.Build();
+  plain.Build();
+  EXPECT_LT(trie.NumNodes() * 2, plain.NumNodes());
+  for (size_t i = 0; i < urls.size(); ++i) {
+    size_t value = 9999;
+    EXPECT_TRUE(trie.Match(urls[i].c_str(), &value));
+    EXPECT_EQ(ARRAY_SIZE(kUrls) + i, value);
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(kUrls); ++i) {
+    size_t value = 9999;
+    EXPECT_TRUE(trie.Match(kUrls[i], &value));
+    EXPECT_EQ(i, value);
+    std::string url(kUrls[i]);
+    EXPECT_FALSE(trie.Match(url.substr(0, url.size() - 1).c_str()));
+    EXPECT_FALSE(trie.Match((url + "x").c_str()));
+    EXPECT_EQ(1U, trie.MatchPrefix((url + "/x").c_str()));
+  }
+
+  std::string path = testing::TempDir() + "da_trie_test_tail.da";
+  ASSERT_TRUE(trie.Save(path));
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  for (size_t i = 0; i < ARRAY_SIZE(kUrls); ++i) {
+    size_t value = 9999;
+    EXPECT_TRUE(mapped.Match(kUrls[i], &value));
+    EXPECT_EQ(i, value);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, ParallelTail) {
+  DaTrie<char, size_t> trie;
+  trie.set_parallel(true);
+  trie.set_tail(true);
+  TestMatch(trie);
+  TestMatchPrefix(trie);
+  TestManyKeys(trie);
+}
+
+TEST(DaTrie, InsertErase) {
+  DaTrie<char, size_t> trie;
+  TestUpdates(trie);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestUpdates(tail);
+
+  DaTrie<char, size_t> parallel;
+  parallel.set_parallel(true);
+  parallel.set_tail(true);
+  TestUpdates(parallel);
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  packed.Insert("abc", 1);
+  packed.Build();
+  EXPECT_FALSE(packed.Insert("abd", 2));
+  EXPECT_FALSE(packed.Erase("abc"));
+  EXPECT_TRUE(packed.Match("abc"));
+}
+
+TEST(DaTrie, InsertEraseMapped) {
+  const char * kPatterns[] = { "a", "bca", "abc", "abcde" };
+  std::string path = testing::TempDir() + "da_trie_test_update.da";
+  DaTrie<char, size_t> trie;
+  trie.set_tail(true);
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    trie.Insert(kPatterns[i], i);
+  }
+  trie.Build();
+  ASSERT_TRUE(trie.Save(path));
+
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  EXPECT_TRUE(mapped.Insert("bcd", 4));
+  EXPECT_TRUE(mapped.Erase("abc"));
+  EXPECT_FALSE(mapped.Erase("abc"));
+  size_t value = 9999;
+  EXPECT_TRUE(mapped.Match("bcd", &value));
+  EXPECT_EQ(4U, value);
+  EXPECT_TRUE(mapped.Match("bca", &value));
+  EXPECT_EQ(1U, value);
+  EXPECT_TRUE(mapped.Match("abcde", &value));
+  EXPECT_EQ(3U, value);
+  EXPECT_FALSE(mapped.Match("abc"));
+
+  // the file is not changed by the updates
+  DaTrie<char, size_t> reopened;
+  ASSERT_TRUE(reopened.Open(path));
+  EXPECT_TRUE(reopened.Match("abc"));
+  EXPECT_FALSE(reopened.Match("bcd"));
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, MemoryUsage) {
+  DaTrie<char, size_t> trie;
+  TestMemoryUsage(trie);
+
+  // the tracker freed by ShrinkToFit is rebuilt for updates
+  EXPECT_TRUE(trie.Insert("abcxyz", 1));
+  EXPECT_GT(trie.MemoryUsage().build, 0U);
+  EXPECT_TRUE(trie.Match("abcxyz"));
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  TestMemoryUsage(packed);
+
+  std::string path = testing::TempDir() + "da_trie_test_memory.da";
+  ASSERT_TRUE(packed.Save(path));
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  MemoryStats stats = mapped.MemoryUsage();
+  EXPECT_EQ(stats.nodes + stats.values + stats.extra, stats.mapped);
+  EXPECT_EQ(packed.MemoryUsage().fill_ratio, stats.fill_ratio);
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, MatchBatch) {
+  DaTrie<char, size_t> trie;
+  TestMatchBatch(trie);
+  const char* kEmpty[] = { "abc" };
+  DaTrie<char, size_t> empty;
+  EXPECT_EQ(0U, empty.MatchBatch(kEmpty, 1, NULL, NULL));
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  TestMatchBatch(packed);
+  EXPECT_EQ(4U, packed.NodeSize());
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestMatchBatch(tail);
+}
+
+TEST(DaTrie, PredictiveSearch) {
+  DaTrie<char, size_t> trie;
+  DaTrie<char, size_t>::Cursor cursor = trie.PredictiveSearch("");
+  EXPECT_FALSE(cursor.Next());
+  TestPredictiveSearch(trie);
+
+  const char * kPatterns[] = { "a", "abc", "abcde", "bc" };
+  trie.Clear();
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    trie.Insert(kPatterns[i], i);
+  }
+  trie.Build();
+  cursor = trie.PredictiveSearch("ab");
+  ASSERT_TRUE(cursor.Next());
+  EXPECT_EQ("abc", cursor.key());
+  EXPECT_EQ(1U, cursor.value());
+  ASSERT_TRUE(cursor.Next());
+  EXPECT_EQ("abcde", cursor.key());
+  EXPECT_EQ(2U, cursor.value());
+  EXPECT_FALSE(cursor.Next());
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  TestPredictiveSearch(packed);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestPredictiveSearch(tail);
+}
+
+TEST(DaTrie, DenseIds) {
+  DaTrie<char, size_t> trie;
+  uint32_t id = 0;
+  EXPECT_FALSE(trie.IdOf("abc", &id));
+  TestDenseIds(trie);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestDenseIds(tail);
+
+  DaTrie<char, size_t> parallel;
+  parallel.set_parallel(true);
+  parallel.set_tail(true);
+  TestDenseIds(parallel);
+
+  const char * kPatterns[] = { "bc", "abcde", "a", "abc", "a" };
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  packed.set_dense_ids(true);
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    packed.Insert(kPatterns[i], i);
+  }
+  packed.Build();
+  EXPECT_EQ(4U, packed.NumKeys());
+  EXPECT_TRUE(packed.IdOf("abcde", &id));
+  EXPECT_EQ(2U, id);
+  std::string key;
+  EXPECT_FALSE(packed.KeyOf(id, &key));
+
+  DaTrie<char, size_t> plain;
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    plain.Insert(kPatterns[i], i);
+  }
+  plain.Build();
+  EXPECT_EQ(0U, plain.NumKeys());
+  EXPECT_FALSE(plain.IdOf("abc", &id));
+  EXPECT_FALSE(plain.KeyOf(0, &key));
+
+  std::string path = testing::TempDir() + "da_trie_test_dense.da";
+  tail.Clear();
+  tail.set_dense_ids(true);
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    tail.Insert(kPatterns[i], i);
+  }
+  tail.Build();
+  ASSERT_TRUE(tail.Save(path));
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  EXPECT_EQ(4U, mapped.NumKeys());
+  EXPECT_TRUE(mapped.KeyOf(3, &key));
+  EXPECT_EQ("bc", key);
+  EXPECT_TRUE(mapped.IdOf("abc", &id));
+  EXPECT_EQ(1U, id);
+
+  // the packed layout keeps no leaves, but its ids survive Save and Open
+  ASSERT_TRUE(packed.Save(path));
+  DaTrie<char, size_t> mapped_packed;
+  ASSERT_TRUE(mapped_packed.Open(path));
+  EXPECT_EQ(4U, mapped_packed.NumKeys());
+  EXPECT_TRUE(mapped_packed.IdOf("abcde", &id));
+  EXPECT_EQ(2U, id);
+  size_t value = 9999;
+  EXPECT_TRUE(mapped_packed.Match("abcde", &value));
+  size_t expected = 9999;
+  EXPECT_TRUE(packed.Match("abcde", &expected));
+  EXPECT_EQ(expected, value);
+  EXPECT_FALSE(mapped_packed.KeyOf(id, &key));
+  std::remove(path.c_str());
+}
+
+/// Random keys of 1 to 4 CJK ideographs
+std::vector<std::u32string> GenerateWideKeys(size_t n) {
+  std::vector<std::u32string> keys;
+  uint32_t seed = 1;
+  for (size_t i = 0; i < n; ++i) {
+    std::u32string key;
+    seed = seed * 1103515245 + 12345;
+    size_t length = 1 + (seed >> 16) % 4;
+    for (size_t j = 0; j < length; ++j) {
+      seed = seed * 1103515245 + 12345;
+      key.push_back(static_cast<char32_t>(0x4E00 + (seed >> 16) % 3000));
+    }
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+TEST(DaTrie, Alphabet) {
+  DaTrie<char, size_t> trie;
+  trie.set_alphabet(true);
+  TestMatch(trie);
+  TestMatchPrefix(trie);
+  TestManyKeys(trie);
+  TestMatchBatch(trie);
+  TestPredictiveSearch(trie);
+  TestUpdates(trie);
+  TestDenseIds(trie);
+
+  DaTrie<char, size_t> tail;
+  tail.set_alphabet(true);
+  tail.set_tail(true);
+  TestManyKeys(tail);
+  TestPredictiveSearch(tail);
+  TestUpdates(tail);
+
+  DaTrie<char, size_t> parallel;
+  parallel.set_alphabet(true);
+  parallel.set_parallel(true);
+  parallel.set_tail(true);
+  TestManyKeys(parallel);
+  TestMatchBatch(parallel);
+  TestUpdates(parallel);
+
+  DaTrie<char, size_t> packed;
+  packed.set_alphabet(true);
+  packed.set_packed(true);
+  TestManyKeys(packed);
+  TestMatchBatch(packed);
+  TestPredictiveSearch(packed);
+
+  // labels first seen by Insert get new codes
+  trie.Clear();
+  trie.Insert("abc", 1);
+  trie.Build();
+  EXPECT_FALSE(trie.Match("xyz"));
+  // an absent label has no child, even where its code would wrap to a unit
+  const char* absent_keys[] = { "xabc", "ab" };
+  std::size_t absent_lengths[] = { 4, 2 };
+  bool found[2] = { true, true };
+  EXPECT_FALSE(trie.Match("xabc"));
+  EXPECT_EQ(0U, trie.MatchBatch(absent_keys, absent_lengths, 2, NULL, found));
+  EXPECT_FALSE(found[0]);
+  EXPECT_TRUE(trie.Insert("xyz", 2));
+  EXPECT_TRUE(trie.Insert("ab\xff", 3));
+  size_t value = 0;
+  EXPECT_TRUE(trie.Match("xyz", &value));
+  EXPECT_EQ(2U, value);
+  EXPECT_TRUE(trie.Match("ab\xff", &value));
+  EXPECT_EQ(3U, value);
+  EXPECT_TRUE(trie.Match("abc"));
+  DaTrie<char, size_t>::Cursor cursor = trie.PredictiveSearch("");
+  ASSERT_TRUE(cursor.Next());
+  EXPECT_EQ("abc", cursor.key());
+  ASSERT_TRUE(cursor.Next());
+  EXPECT_EQ("ab\xff", cursor.key());
+  ASSERT_TRUE(cursor.Next());
+  EXPECT_EQ("xyz", cursor.key());
+  EXPECT_FALSE(cursor.Next());
+}
+
+TEST(DaTrie, WideAlphabet) {
+  std::vector<std::u32string> keys = GenerateWideKeys(5000);
+  DaTrie<char32_t, size_t> raw;
+  DaTrie<char32_t, size_t> trie;
+  trie.set_alphabet(true);
+  trie.set_dense_ids(true);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    raw.Insert(keys[i].data(), keys[i].size(), i);
+    trie.Insert(keys[i].data(), keys[i].size(), i);
+  }
+  raw.Build();
+  trie.Build();
+  EXPECT_LT(trie.NumNodes() * 2, raw.NumNodes());
+
+  std::vector<std::u32string> sorted(keys);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  ASSERT_EQ(sorted.size(), trie.NumKeys());
+  std::u32string key;
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    size_t value = 0;
+    ASSERT_TRUE(trie.Match(sorted[i].data(), sorted[i].size(), &value));
+    EXPECT_EQ(sorted[i], keys[value]);
+    ASSERT_TRUE(trie.KeyOf(i, &key));
+    EXPECT_EQ(sorted[i], key);
+  }
+  std::u32string absent(1, static_cast<char32_t>(0x3042));
+  EXPECT_FALSE(trie.Match(absent.data(), absent.size()));
+
+  // without the remap, children are probed up to the largest label only
+  const std::u32string prefix = sorted[0].substr(0, 2);
+  DaTrie<char32_t, size_t>::Cursor raw_cursor = raw.PredictiveSearch(
+      prefix.data(), prefix.data() + prefix.size());
+  for (size_t i = 0; i < sorted.size() && sorted[i].compare(0, 2, prefix) == 0; ++i) {
+    ASSERT_TRUE(raw_cursor.Next());
+    EXPECT_EQ(sorted[i], raw_cursor.key());
+  }
+  EXPECT_FALSE(raw_cursor.Next());
+  for (size_t i = 0; i < sorted.size(); i += 16) {
+    EXPECT_TRUE(raw.Erase(sorted[i].data(), sorted[i].size()));
+  }
+  EXPECT_TRUE(raw.Insert(absent.data(), absent.size(), 7));
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    EXPECT_EQ(i % 16 != 0, raw.Match(sorted[i].data(), sorted[i].size()));
+  }
+  EXPECT_TRUE(raw.Match(absent.data(), absent.size()));
+
+  std::string path = testing::TempDir() + "da_trie_test_wide.da";
+  ASSERT_TRUE(trie.Save(path));
+  DaTrie<char32_t, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  DaTrie<char32_t, size_t>::Cursor cursor = mapped.PredictiveSearch(absent.data(), absent.data());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    ASSERT_TRUE(cursor.Next());
+    EXPECT_EQ(sorted[i], cursor.key());
+  }
+  EXPECT_FALSE(cursor.Next());
+  EXPECT_FALSE(mapped.Match(absent.data(), absent.size()));
+  EXPECT_TRUE(mapped.Insert(absent.data(), absent.size(), 7));
+  EXPECT_TRUE(mapped.Match(sorted[0].data(), sorted[0].size()));
+  EXPECT_TRUE(mapped.Match(absent.data(), absent.size()));
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, FuzzyMatch) {
+  DaTrie<char, size_t> trie;
+  TestFuzzyMatch(trie);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestFuzzyMatch(tail);
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  TestFuzzyMatch(packed);
+
+  DaTrie<char, size_t> alphabet;
+  alphabet.set_alphabet(true);
+  TestFuzzyMatch(alphabet);
+}
+
+TEST(DaTrie, StaticTrie) {
+  DaTrie<char, size_t> trie;
+  TestStaticTrie(trie);
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  TestStaticTrie(packed);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestStaticTrie(tail);
+}
+
+TEST(DaTrie, Relayout) {
+  DaTrie<char, size_t> trie;
+  TestRelayout(trie);
+
+  DaTrie<char, size_t> tail;
+  tail.set_tail(true);
+  TestRelayout(tail);
+
+  DaTrie<char, size_t> alphabet;
+  alphabet.set_alphabet(true);
+  TestRelayout(alphabet);
+
+  DaTrie<char, size_t> packed;
+  packed.set_packed(true);
+  packed.Insert("abc", 1);
+  packed.Build();
+  const char* sample[] = { "abc" };
+  EXPECT_FALSE(packed.Relayout(sample, 1));
+
+  // dense ids and updates after a relayout
+  std::vector<std::string> keys = GenerateKeys(3000);
+  DaTrie<char, size_t> dense;
+  dense.set_dense_ids(true);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    dense.Insert(keys[i].c_str(), i);
+  }
+  dense.Build();
+  std::vector<uint32_t> ids(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(dense.IdOf(keys[i].c_str(), &ids[i]));
+  }
+  std::vector<const char*> queries;
+  for (size_t i = 0; i < 100; ++i) {
+    queries.push_back(keys[i % 7].c_str());
+  }
+  ASSERT_TRUE(dense.Relayout(&queries[0], queries.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    uint32_t id = 0;
+    ASSERT_TRUE(dense.IdOf(keys[i].c_str(), &id));
+    EXPECT_EQ(ids[i], id);
+    std::string key;
+    ASSERT_TRUE(dense.KeyOf(id, &key));
+    EXPECT_EQ(keys[i], key);
+  }
+  EXPECT_TRUE(dense.Insert("relaid", 7));
+  size_t value = 0;
+  EXPECT_TRUE(dense.Match("relaid", &value));
+  EXPECT_EQ(7U, value);
+  EXPECT_TRUE(dense.Match(keys[0].c_str()));
+
+  // a mapped trie is copied before its units are rewritten
+  std::string path = testing::TempDir() + "da_trie_test_relayout.da";
+  ASSERT_TRUE(dense.Save(path));
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  ASSERT_TRUE(mapped.Relayout(&queries[0], queries.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t expected = 0;
+    ASSERT_TRUE(dense.Match(keys[i].c_str(), &expected));
+    ASSERT_TRUE(mapped.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(expected, value) << " key: " << keys[i];
+    uint32_t id = 0;
+    ASSERT_TRUE(mapped.IdOf(keys[i].c_str(), &id));
+    EXPECT_EQ(ids[i], id);
+  }
+  EXPECT_TRUE(mapped.Match("relaid"));
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, SaveOpen) {
+  const char * kPatterns[] = { "a", "bca", "abc", "abcde" };
+  std::string path = testing::TempDir() + "da_trie_test.da";
+  DaTrie<char, size_t> trie;
+  EXPECT_FALSE(trie.Save(path));
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    trie.Insert(kPatterns[i], i);
+  }
+  trie.Build();
+  ASSERT_TRUE(trie.Save(path));
+
+  DaTrie<char, size_t> mapped;
+  ASSERT_TRUE(mapped.Open(path));
+  EXPECT_TRUE(mapped.IsBuilt());
+  EXPECT_EQ(trie.NumNodes(), mapped.NumNodes());
+  Trie<char, size_t>& base = mapped;
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    size_t value = 9999;
+    EXPECT_TRUE(base.Match(kPatterns[i], &value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(base.Match("ab"));
+  std::vector<size_t> values;
+  EXPECT_EQ(3U, base.MatchPrefix("abcdefgh", &values));
+
+  // a copy shares the mapping
+  DaTrie<char, size_t> copy(mapped);
+  mapped.Clear();
+  EXPECT_TRUE(copy.Match("bca"));
+
+  // the file is not changed by Clear/Build on the mapped instance
+  mapped.Insert("xyz", 7);
+  mapped.Build();
+  EXPECT_TRUE(mapped.Match("xyz"));
+  EXPECT_TRUE(mapped.Open(path));
+  EXPECT_TRUE(mapped.Match("abcde"));
+  EXPECT_FALSE(mapped.Match("xyz"));
+  std::remove(path.c_str());
+}
+
+TEST(DaTrie, OpenInvalid) {
+  std::string path = testing::TempDir() + "da_trie_test_invalid.da";
+  DaTrie<char, size_t> trie;
+  trie.Insert("abc", 1);
+  trie.Build();
+  ASSERT_TRUE(trie.Save(path));
+
+  DaTrie<char, uint32_t> other_value;
+  EXPECT_FALSE(other_value.Open(path));
+  EXPECT_FALSE(other_value.IsBuilt());
+
+  std::ifstream in(path.c_str(), std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(content.data(), static_cast<std::streamsize>(content.size() / 2));
+  out.close();
+  DaTrie<char, size_t> truncated;
+  EXPECT_FALSE(truncated.Open(path));
+  EXPECT_FALSE(truncated.Open(path + ".missing"));
+  std::remove(path.c_str());
+}
+
 }  // namespace balgo
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_LABEL_SCAN_H_
+#define BALGO_TRIE_LABEL_SCAN_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace balgo {
+
+/**
+ * @brief Finds a label among the n unsorted labels of a node by comparing a
+ * whole vector of them at a time
+ *
+ * The vector versions read up to kPadding labels past labels + n, so the
+ * array must be padded.
+ */
+template<int size>
+struct LabelScan {
+  static const std::size_t kPadding = 0;
+
+  /// @return the index of label in [labels, labels + n), or n
+  template<typename Char>
+  static std::size_t Find(const Char* labels, std::size_t n, Char label) {
+    std::size_t i = 0;
+    while (i < n && labels[i] != label) {
+      ++i;
+    }
+    return i;
+  }
+};
+
+#ifdef __SSE2__
+
+/// Compares 16 / size labels of size bytes per step with SSE2
+template<int size>
+struct VectorLabelScan {
+  static const std::size_t kWidth = 16 / size;
+  static const std::size_t kPadding = kWidth - 1;
+
+  template<typename Char>
+  static std::size_t Find(const Char* labels, std::size_t n, Char label) {
+    __m128i key = Broadcast(label);
+    for (std::size_t i = 0; i < n; i += kWidth) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(labels + i));
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(Equal(block, key)));
+      if (n - i < kWidth) {
+        mask &= (1U << ((n - i) * size)) - 1;
+      }
+      if (mask != 0) {
+        return i + static_cast<std::size_t>(__builtin_ctz(mask)) / size;
+      }
+    }
+    return n;
+  }
+
+ private:
+  template<typename Char>
+  static __m128i Broadcast(Char label) {
+    // copy the bits, whatever the signedness of Char
+    if (size == 1) {
+      int8_t bits;
+      std::memcpy(&bits, &label, 1);
+      return _mm_set1_epi8(bits);
+    }
+    if (size == 2) {
+      int16_t bits;
+      std::memcpy(&bits, &label, 2);
+      return _mm_set1_epi16(bits);
+    }
+    int32_t bits;
+    std::memcpy(&bits, &label, 4);
+    return _mm_set1_epi32(bits);
+  }
+
+  static __m128i Equal(__m128i a, __m128i b) {
+    if (size == 1) return _mm_cmpeq_epi8(a, b);
+    if (size == 2) return _mm_cmpeq_epi16(a, b);
+    return _mm_cmpeq_epi32(a, b);
+  }
+};
+
+template<>
+struct LabelScan<1> : VectorLabelScan<1> { };
+
+template<>
+struct LabelScan<2> : VectorLabelScan<2> { };
+
+template<>
+struct LabelScan<4> : VectorLabelScan<4> { };
+
+#endif  // __SSE2__
+
+/// @return the index of label in [labels, labels + n), or n
+template<typename Char>
+std::size_t FindLabel(const Char* labels, std::size_t n, Char label) {
+  return LabelScan<sizeof(Char)>::Find(labels, n, label);
+}
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_LABEL_SCAN_H_
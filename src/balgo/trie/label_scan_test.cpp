@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "label_scan.h"
+
+namespace balgo {
+
+/// Looks up every label of [0, n) and some absent ones, for every n
+template<typename Char>
+void TestFindLabel() {
+  const std::size_t kMax = 40;
+  // absent labels in the padding must not match
+  std::vector<Char> labels(kMax + LabelScan<sizeof(Char)>::kPadding, static_cast<Char>(7));
+  for (std::size_t i = 0; i < kMax; ++i) {
+    labels[i] = static_cast<Char>(100 + 3 * i);
+  }
+  labels[kMax - 1] = static_cast<Char>(-1);
+  for (std::size_t n = 0; n <= kMax; ++n) {
+    for (std::size_t i = 0; i < kMax; ++i) {
+      EXPECT_EQ(i < n ? i : n, FindLabel(&labels[0], n, labels[i])) << " n: " << n;
+    }
+    EXPECT_EQ(n, FindLabel(&labels[0], n, static_cast<Char>(7))) << " n: " << n;
+    EXPECT_EQ(n, FindLabel(&labels[0], n, static_cast<Char>(101))) << " n: " << n;
+  }
+}
+
+TEST(LabelScan, FindLabel) {
+  TestFindLabel<char>();
+  TestFindLabel<unsigned char>();
+  TestFindLabel<uint16_t>();
+  TestFindLabel<char32_t>();
+  TestFindLabel<uint64_t>();
+}
+
+TEST(LabelScan, FirstMatch) {
+  std::string abc = "abcabcabcabcabcabcab";
+  std::vector<char> labels(abc.begin(), abc.end());
+  labels.resize(abc.size() + LabelScan<1>::kPadding, '\0');
+  EXPECT_EQ(2U, FindLabel(&labels[0], abc.size(), 'c'));
+  EXPECT_EQ(abc.size(), FindLabel(&labels[0], abc.size(), 'd'));
+}
+
+}  // namespace balgo
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_LOUDS_TRIE_H_
+#define BALGO_TRIE_LOUDS_TRIE_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bit_vector.h"
+#include "label_scan.h"
+#include "memory_stats.h"
+#include "trie_traits.h"
+#include "trie.h"
+
+namespace balgo {
+
+/**
+ * @brief Succinct trie in the level-order unary degree sequence (LOUDS)
+ *
+ * The nodes are numbered in breadth-first order. The shape is one bit
+ * vector, in which every node writes a one per child and then a zero, after
+ * a leading "10" for the root; the children of node v are then numbered
+ * from Select0(v) - v on, and their labels are contiguous in labels_. A
+ * second bit vector flags the final nodes, whose values are kept in node
+ * order and found by Rank1. With the rank and select directories, a node
+ * costs about 2.3 bits of shape, 1.1 bits of terminal flag and its label,
+ * e.g. 11.4 bits with char labels.
+ *
+ * The trie is static: Insert and Erase after Build fail.
+ */
+template<typename Char = char, typename Value = uint32_t, typename NodePtr = uint32_t>
+class LoudsTrie : public Trie<Char, Value, NodePtr> {
+ public:
+  typedef typename TrieTraits<Char>::UChar UChar;
+
+  struct Key;
+  typedef std::vector<Char> LabelContainer;
+  typedef std::vector<Key> KeyContainer;
+  typedef std::vector<NodePtr> KidContainer;
+  typedef std::vector<Value> ValueContainer;
+
+  struct Key {
+    const Char* ptr;
+    std::size_t length;
+    Key(const Char* p, std::size_t l)
+        : ptr(p),
+          length(l) {
+    }
+    /// Orders by the unsigned labels, which is the order of the children
+    bool operator<(const Key& rhs) const {
+      std::size_t minlen = std::min(length, rhs.length);
+      for (std::size_t i = 0; i < minlen; ++i) {
+        if (ptr[i] != rhs.ptr[i]) {
+          return static_cast<UChar>(ptr[i]) < static_cast<UChar>(rhs.ptr[i]);
+        }
+      }
+      return length < rhs.length;
+    }
+    bool operator==(const Key& rhs) const {
+      return length == rhs.length && std::equal(ptr, ptr + length, rhs.ptr);
+    }
+  };
+  class KeyIdLess {
+   public:
+    explicit KeyIdLess(const KeyContainer& keys)
+        : keys_(keys) {
+    }
+    bool operator()(const NodePtr lhs, const NodePtr rhs) const {
+      return keys_[lhs] < keys_[rhs];
+    }
+   private:
+    const KeyContainer& keys_;
+  };
+  class KeyIdEqual {
+   public:
+    explicit KeyIdEqual(const KeyContainer& keys)
+        : keys_(keys) {
+    }
+    bool operator()(const NodePtr lhs, const NodePtr rhs) const {
+      return keys_[lhs] == keys_[rhs];
+    }
+   private:
+    const KeyContainer& keys_;
+  };
+
+  LoudsTrie() : peak_bytes_(0) { }
+  virtual ~LoudsTrie() { }
+
+  /// Average bytes per node, rounded up; see BitsPerNode for the exact figure
+  virtual std::size_t NodeSize() const {
+    std::size_t nodes = NumNodes();
+    return nodes ? (NodeBytes() + nodes - 1) / nodes : 0;
+  }
+
+  /// Number of nodes plus one, as node Null is not stored
+  virtual std::size_t NumNodes() const {
+    return terminals_.size() + Root();
+  }
+
+  virtual std::string Name() const {
+    return "LoudsTrie";
+  }
+
+  /// Bits of shape, terminal flags and label per node, with their directories
+  double BitsPerNode() const {
+    return terminals_.size() ? 8.0 * NodeBytes() / terminals_.size() : 0;
+  }
+
+  virtual MemoryStats MemoryUsage() const {
+    MemoryStats stats;
+    stats.nodes = NodeBytes();
+    stats.values = SizeInBytes(values_);
+    stats.extra = (labels_.size() - terminals_.size()) * sizeof(Char);  // padding of labels_
+    stats.build = CapacityInBytes(kids_) + CapacityInBytes(keys_) + CapacityInBytes(inserted_);
+    stats.slack = louds_.CapacityBytes() - louds_.MemoryBytes() + terminals_.CapacityBytes()
+        - terminals_.MemoryBytes() + SlackInBytes(labels_) + SlackInBytes(values_);
+    stats.peak = peak_bytes_;
+    if (terminals_.size()) {
+      stats.fill_ratio = 1;
+    }
+    return stats;
+  }
+
+  virtual void ShrinkToFit() {
+    if (!this->IsBuilt()) {
+      return;
+    }
+    KidContainer().swap(kids_);
+    KeyContainer().swap(keys_);
+    ValueContainer().swap(inserted_);
+    louds_.ShrinkToFit();
+    terminals_.ShrinkToFit();
+    LabelContainer(labels_).swap(labels_);
+    ValueContainer(values_).swap(values_);
+  }
+
+  virtual std::string ToString() const {
+    std::stringstream ss;
+    for (std::size_t v = 0; v < terminals_.size(); ++v) {
+      std::size_t first = FirstChild(v);
+      ss << "[" << v + Root() << "] label=" << std::hex
+          << static_cast<uint64_t>(static_cast<UChar>(labels_[v])) << std::dec << ", child="
+          << first + Root() << ", nchild=" << louds_.OnesFrom(first + v + 1) << ", final="
+          << terminals_.Get(v) << "\n";
+    }
+    return ss.str();
+  }
+
+ protected:
+  virtual NodePtr Root() const {
+    return 1;
+  }
+
+  virtual NodePtr Child(NodePtr parent, Char label) const {
+    std::size_t v = parent - Root();
+    std::size_t pos = louds_.Select0(v) + 1;
+    std::size_t n = louds_.OnesFrom(pos);
+    std::size_t first = pos - v - 1;
+    const Char* begin = &labels_[0] + first;
+    std::size_t i;
+    if (n <= kScanLabels) {
+      i = FindLabel(begin, n, label);
+    } else {
+      i = static_cast<std::size_t>(std::lower_bound(begin, begin + n, label, LabelLess())
+                                   - begin);
+      if (i < n && begin[i] != label) {
+        i = n;
+      }
+    }
+    return i < n ? static_cast<NodePtr>(first + i + Root()) : Null();
+  }
+
+  virtual bool IsNull(NodePtr p) const {
+    return p == Null();
+  }
+
+  virtual bool IsFinal(NodePtr node) const {
+    return terminals_.Get(node - Root());
+  }
+
+  virtual const Value* GetValue(NodePtr node) const {
+    std::size_t v = node - Root();
+    if (terminals_.Get(v)) {
+      return &values_[terminals_.Rank1(v)];
+    }
+    return NULL;
+  }
+
+  virtual NodePtr NextChild(NodePtr parent, std::size_t* next, Char* label) const {
+    std::size_t v = parent - Root();
+    std::size_t pos = louds_.Select0(v) + 1;
+    if (*next >= louds_.OnesFrom(pos)) {
+      return Null();
+    }
+    std::size_t child = pos - v - 1 + (*next)++;
+    *label = labels_[child];
+    return static_cast<NodePtr>(child + Root());
+  }
+
+  virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
+    if (begin != end) {
+      std::size_t length = static_cast<std::size_t>(std::distance(begin, end));
+      keys_.push_back(Key(begin, length));
+      inserted_.push_back(value);
+    }
+  }
+
+  virtual void DoBuild(bool sort = true) {
+    kids_.clear();
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+      kids_.push_back(static_cast<NodePtr>(i));
+    }
+    if (sort) {
+      std::sort(kids_.begin(), kids_.end(), KeyIdLess(keys_));
+      typename KidContainer::iterator new_end = std::unique(kids_.begin(), kids_.end(),
+                                                            KeyIdEqual(keys_));
+      kids_.resize(static_cast<std::size_t>(std::distance(kids_.begin(), new_end)));
+    }
+    ClearLevels();
+    BuildLevels();
+    peak_bytes_ = louds_.CapacityBytes() + terminals_.CapacityBytes() + CapacityInBytes(labels_)
+        + CapacityInBytes(values_) + CapacityInBytes(kids_) + CapacityInBytes(keys_)
+        + CapacityInBytes(inserted_);
+
+    // release keys_
+    KeyContainer().swap(keys_);
+    ValueContainer().swap(inserted_);
+  }
+
+  virtual void DoClear() {
+    peak_bytes_ = 0;
+    ClearLevels();
+    kids_.clear();
+    keys_.clear();
+    inserted_.clear();
+  }
+
+ private:
+  template<typename> friend class StaticTrie;
+
+  /// A node to lay out: the keys [begin, end) of kids_ share its depth labels
+  struct Range {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t depth;
+    Range(std::size_t b, std::size_t e, std::size_t d) : begin(b), end(e), depth(d) { }
+  };
+
+  /// Orders labels as unsigned, like Key
+  struct LabelLess {
+    bool operator()(Char lhs, Char rhs) const {
+      return static_cast<UChar>(lhs) < static_cast<UChar>(rhs);
+    }
+  };
+
+  /// Fan-outs up to this many labels are scanned rather than binary searched
+  static const std::size_t kScanLabels = 32;
+
+  static Char NullChar() {
+    return 0;
+  }
+
+  static NodePtr Null() {
+    return 0;
+  }
+
+  std::size_t FirstChild(std::size_t v) const {
+    return louds_.Select0(v) - v;
+  }
+
+  std::size_t NodeBytes() const {
+    return louds_.MemoryBytes() + terminals_.MemoryBytes() + terminals_.size() * sizeof(Char);
+  }
+
+  void ClearLevels() {
+    louds_.Clear();
+    terminals_.Clear();
+    labels_.clear();
+    values_.clear();
+  }
+
+  /// Lays the nodes out level by level from the sorted keys
+  void BuildLevels() {
+    std::deque<Range> queue;
+    queue.push_back(Range(0, kids_.size(), 0));
+    labels_.push_back(NullChar());
+    louds_.PushBack(true);
+    louds_.PushBack(false);
+    while (!queue.empty()) {
+      Range range = queue.front();
+      queue.pop_front();
+      std::size_t i = range.begin;
+      bool final = i < range.end && keys_[kids_[i]].length == range.depth;
+      terminals_.PushBack(final);
+      if (final) {
+        values_.push_back(inserted_[kids_[i++]]);
+      }
+      while (i < range.end) {
+        Char label = keys_[kids_[i]].ptr[range.depth];
+        std::size_t j = i + 1;
+        while (j < range.end && keys_[kids_[j]].ptr[range.depth] == label) {
+          ++j;
+        }
+        louds_.PushBack(true);
+        labels_.push_back(label);
+        queue.push_back(Range(i, j, range.depth + 1));
+        i = j;
+      }
+      louds_.PushBack(false);
+    }
+    louds_.Build();
+    terminals_.Build();
+    // FindLabel may read a vector past the last sibling
+    labels_.resize(terminals_.size() + LabelScan<sizeof(Char)>::kPadding, NullChar());
+  }
+
+  BitVector louds_;         ///< Unary degrees in breadth-first order
+  BitVector terminals_;     ///< Whether each node is final
+  LabelContainer labels_;   ///< Label of each node, padded for FindLabel
+  ValueContainer values_;   ///< Values of the final nodes, in node order
+  KidContainer kids_;
+  KeyContainer keys_;       // Released at the end of Build
+  ValueContainer inserted_;  // Values of keys_, released at the end of Build
+  std::size_t peak_bytes_;  ///< Peak allocation of the last Build
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_LOUDS_TRIE_H_
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "trie_test_common.h"
+#include "louds_trie.h"
+
+namespace balgo {
+
+TEST(LoudsTrie, Match) {
+  LoudsTrie<char, size_t> trie;
+  TestMatch(trie);
+}
+
+TEST(LoudsTrie, MatchPrefix) {
+  LoudsTrie<char, size_t> trie;
+  TestMatchPrefix(trie);
+}
+
+TEST(LoudsTrie, MatchPrefixVisitor) {
+  LoudsTrie<char, size_t> trie;
+  TestMatchPrefixVisitor(trie);
+}
+
+TEST(LoudsTrie, Segment) {
+  LoudsTrie<char, size_t> trie;
+  TestSegment(trie);
+}
+
+TEST(LoudsTrie, FuzzyMatch) {
+  LoudsTrie<char, size_t> trie;
+  TestFuzzyMatch(trie);
+}
+
+TEST(LoudsTrie, StaticTrie) {
+  LoudsTrie<char, size_t> trie;
+  TestStaticTrie(trie);
+}
+
+TEST(LoudsTrie, Keys) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  std::vector<std::string> others = GenerateKeys(20000, 2);
+  LoudsTrie<char, size_t> trie;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 0;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(keys[i], keys[value]);
+  }
+  std::sort(keys.begin(), keys.end());
+  for (size_t i = 0; i < others.size(); ++i) {
+    EXPECT_EQ(std::binary_search(keys.begin(), keys.end(), others[i]),
+              trie.Match(others[i].c_str())) << " key: " << others[i];
+  }
+  EXPECT_FALSE(trie.Insert("new", 1));
+}
+
+TEST(LoudsTrie, WideFanOut) {
+  // fan-outs on both sides of the scan limit, and labels above 0x7f
+  LoudsTrie<char, size_t> trie;
+  std::vector<std::string> keys;
+  for (int first = 1; first < 256; first += 3) {
+    for (int second = 1; second <= first; second += 7) {
+      std::string key(1, static_cast<char>(first));
+      key.push_back(static_cast<char>(second));
+      keys.push_back(key);
+    }
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 0;
+    EXPECT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << i;
+    EXPECT_EQ(i, value);
+    std::string absent(keys[i]);
+    absent[0] = static_cast<char>(absent[0] + 1);
+    EXPECT_FALSE(trie.Match(absent.c_str())) << " key: " << i;
+    EXPECT_FALSE(trie.Match(keys[i].c_str(), 1)) << " key: " << i;
+  }
+}
+
+TEST(LoudsTrie, MemoryUsage) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  LoudsTrie<char, size_t> trie;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  MemoryStats stats = trie.MemoryUsage();
+  EXPECT_GE(trie.NodeSize() * trie.NumNodes(), stats.nodes);
+  EXPECT_GE(trie.BitsPerNode(), 11);
+  EXPECT_LE(trie.BitsPerNode(), 12);
+  EXPECT_GT(stats.build, 0U);
+  EXPECT_GE(stats.peak, stats.nodes + stats.values + stats.build);
+
+  trie.ShrinkToFit();
+  MemoryStats shrunk = trie.MemoryUsage();
+  EXPECT_EQ(0U, shrunk.build);
+  EXPECT_EQ(0U, shrunk.slack);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.Match(keys[i].c_str())) << " key: " << keys[i];
+  }
+}
+
+}  // namespace balgo
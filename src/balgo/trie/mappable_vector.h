@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_MAPPABLE_VECTOR_H_
+#define BALGO_TRIE_MAPPABLE_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace balgo {
+
+/**
+ * @brief A vector that either owns its elements or views a MappedFile
+ *
+ * Const access always goes through a raw pointer, so lookups cost the same
+ * in both cases. resize and push_back on a mapped vector first copy the
+ * elements into owned storage; non-const operator[] requires owned storage,
+ * which is asserted rather than made so, to keep writes in build loops cheap.
+ */
+template<typename T>
+class MappableVector {
+ public:
+  typedef std::vector<T> Container;
+  typedef T value_type;
+
+  MappableVector()
+      : data_(NULL),
+        size_(0) {
+  }
+
+  MappableVector(const MappableVector& other)
+      : vec_(other.vec_),
+        file_(other.file_) {
+    Sync(other);
+  }
+
+  MappableVector& operator=(const MappableVector& other) {
+    if (this != &other) {
+      vec_ = other.vec_;
+      file_ = other.file_;
+      Sync(other);
+    }
+    return *this;
+  }
+
+  const T& operator[](std::size_t i) const {
+    return data_[i];
+  }
+
+  T& operator[](std::size_t i) {
+    assert(!mapped());
+    return vec_[i];
+  }
+
+  const T* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  std::size_t capacity() const {
+    return mapped() ? size_ : vec_.capacity();
+  }
+
+  const T& back() const {
+    return data_[size_ - 1];
+  }
+
+  void resize(std::size_t n, const T& value = T()) {
+    Detach();
+    vec_.resize(n, value);
+    Sync();
+  }
+
+  void push_back(const T& value) {
+    Detach();
+    vec_.push_back(value);
+    Sync();
+  }
+
+  void clear() {
+    file_.reset();
+    vec_.clear();
+    Sync();
+  }
+
+  /// Frees the owned storage as well, unlike clear
+  void Release() {
+    file_.reset();
+    Container().swap(vec_);
+    Sync();
+  }
+
+  /// Frees the owned capacity beyond the size
+  void shrink_to_fit() {
+    if (!mapped() && vec_.capacity() > vec_.size()) {
+      Container(vec_).swap(vec_);
+      Sync();
+    }
+  }
+
+  /// Views n elements at data, which must stay valid as long as file does
+  void Map(const T* data, std::size_t n, const std::shared_ptr<MappedFile>& file) {
+    Container().swap(vec_);
+    file_ = file;
+    data_ = data;
+    size_ = n;
+  }
+
+  bool mapped() const {
+    return static_cast<bool>(file_);
+  }
+
+  /// Copies mapped elements into owned storage
+  void Detach() {
+    if (mapped()) {
+      Container(data_, data_ + size_).swap(vec_);
+      file_.reset();
+      Sync();
+    }
+  }
+
+ private:
+  void Sync() {
+    data_ = vec_.empty() ? NULL : &vec_[0];
+    size_ = vec_.size();
+  }
+
+  void Sync(const MappableVector& other) {
+    if (other.mapped()) {
+      data_ = other.data_;
+      size_ = other.size_;
+    } else {
+      Sync();
+    }
+  }
+
+  Container vec_;
+  std::shared_ptr<MappedFile> file_;  ///< Keeps the mapping alive
+  const T* data_;
+  std::size_t size_;
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_MAPPABLE_VECTOR_H_
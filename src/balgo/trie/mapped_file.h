@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_MAPPED_FILE_H_
+#define BALGO_TRIE_MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstddef>
+#include <string>
+
+namespace balgo {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The mapping is shared, so processes mapping the same file share one copy
+ * in the page cache.
+ */
+class MappedFile {
+ public:
+  MappedFile()
+      : data_(NULL),
+        size_(0) {
+  }
+
+  ~MappedFile() {
+    Close();
+  }
+
+  bool Open(const std::string& path) {
+    Close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+      ::close(fd);
+      return false;
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* addr = ::mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      return false;
+    }
+    data_ = static_cast<const char*>(addr);
+    size_ = size;
+    return true;
+  }
+
+  void Close() {
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+      data_ = NULL;
+      size_ = 0;
+    }
+  }
+
+  const char* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+
+  const char* data_;
+  std::size_t size_;
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_MAPPED_FILE_H_
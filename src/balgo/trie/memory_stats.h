@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_MEMORY_STATS_H_
+#define BALGO_TRIE_MEMORY_STATS_H_
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace balgo {
+
+/**
+ * @brief Memory breakdown of a trie or matcher, in bytes
+ *
+ * Each component counts the sizes of its arrays; the capacity allocated
+ * beyond those sizes is counted once, in slack.
+ */
+struct MemoryStats {
+  std::size_t nodes;   ///< Node arrays
+  std::size_t values;  ///< Values
+  std::size_t extra;   ///< Other lookup arrays, e.g. tails
+  std::size_t build;   ///< Build-only structures still held, freed by ShrinkToFit
+  std::size_t slack;   ///< Unused capacity of the lookup arrays
+  std::size_t mapped;  ///< Part of the lookup arrays viewing a mapped file
+  std::size_t peak;    ///< Peak allocation seen during the last Build
+  double fill_ratio;   ///< Fraction of the node slots in use
+
+  MemoryStats()
+      : nodes(0),
+        values(0),
+        extra(0),
+        build(0),
+        slack(0),
+        mapped(0),
+        peak(0),
+        fill_ratio(0) {
+  }
+
+  std::size_t Total() const {
+    return nodes + values + extra + build + slack;
+  }
+
+  std::string ToString() const {
+    std::stringstream ss;
+    ss << "total=" << Total() << ", nodes=" << nodes << ", values=" << values << ", extra="
+        << extra << ", build=" << build << ", slack=" << slack << ", mapped=" << mapped
+        << ", peak=" << peak << ", fill_ratio=" << fill_ratio;
+    return ss.str();
+  }
+};
+
+template<typename Vector>
+std::size_t SizeInBytes(const Vector& vec) {
+  return vec.size() * sizeof(typename Vector::value_type);
+}
+
+template<typename Vector>
+std::size_t CapacityInBytes(const Vector& vec) {
+  return vec.capacity() * sizeof(typename Vector::value_type);
+}
+
+template<typename Vector>
+std::size_t SlackInBytes(const Vector& vec) {
+  return CapacityInBytes(vec) - SizeInBytes(vec);
+}
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_MEMORY_STATS_H_
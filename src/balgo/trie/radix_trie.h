@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_RADIX_TRIE_H_
+#define BALGO_TRIE_RADIX_TRIE_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "label_scan.h"
+#include "memory_stats.h"
+#include "trie_traits.h"
+#include "trie.h"
+
+namespace balgo {
+
+/**
+ * @brief Path-compressed (radix, Patricia) trie
+ *
+ * Every chain of nodes with a single child and no value is collapsed into
+ * one edge, so a node is a branch or a key end. The children of a node are
+ * contiguous, with their first labels kept apart in firsts_ for FindLabel,
+ * and the rest of an edge is a span of the label pool. Match compares such a
+ * span at once. The Trie interface still steps one label at a time: inside
+ * an edge a node pointer is the flagged pool position of the next label,
+ * and the pool ends every span with NullChar and the node it leads to.
+ * Edges never span a NullChar label, which is always the first of an edge.
+ *
+ * The trie is static: Insert and Erase after Build fail.
+ */
+template<typename Char = char, typename Value = uint32_t, typename NodePtr = uint32_t>
+class RadixTrie : public Trie<Char, Value, NodePtr> {
+ public:
+  typedef Trie<Char, Value, NodePtr> Base;
+  typedef typename TrieTraits<Char>::UChar UChar;
+
+  struct Node;
+  struct Key;
+  typedef std::vector<Node> NodeContainer;
+  typedef std::vector<Char> LabelContainer;
+  typedef std::vector<Key> KeyContainer;
+  typedef std::vector<NodePtr> KidContainer;
+  typedef std::vector<Value> ValueContainer;
+
+  struct Node {
+    NodePtr child;   ///< First child
+    NodePtr nchild;
+    NodePtr tail;    ///< Pool position of the labels after the first
+    NodePtr length;  ///< Labels on the edge into this node
+    NodePtr value;   ///< Value index plus one, 0 if not final
+    Node()
+        : child(Null()),
+          nchild(0),
+          tail(0),
+          length(1),
+          value(0) {
+    }
+    std::string ToString() const {
+      std::stringstream ss;
+      ss << this << "(child=" << child << ", nchild=" << nchild << ", tail=" << tail
+          << ", length=" << length << ", value=" << value << ")";
+      return ss.str();
+    }
+  };
+
+  struct Key {
+    const Char* ptr;
+    std::size_t length;
+    Key(const Char* p, std::size_t l)
+        : ptr(p),
+          length(l) {
+    }
+    /// Orders by the unsigned labels, which is the order of the children
+    bool operator<(const Key& rhs) const {
+      std::size_t minlen = std::min(length, rhs.length);
+      for (std::size_t i = 0; i < minlen; ++i) {
+        if (ptr[i] != rhs.ptr[i]) {
+          return static_cast<UChar>(ptr[i]) < static_cast<UChar>(rhs.ptr[i]);
+        }
+      }
+      return length < rhs.length;
+    }
+    bool operator==(const Key& rhs) const {
+      return length == rhs.length && std::equal(ptr, ptr + length, rhs.ptr);
+    }
+  };
+  class KeyIdLess {
+   public:
+    explicit KeyIdLess(const KeyContainer& keys)
+        : keys_(keys) {
+    }
+    bool operator()(const NodePtr lhs, const NodePtr rhs) const {
+      return keys_[lhs] < keys_[rhs];
+    }
+   private:
+    const KeyContainer& keys_;
+  };
+  class KeyIdEqual {
+   public:
+    explicit KeyIdEqual(const KeyContainer& keys)
+        : keys_(keys) {
+    }
+    bool operator()(const NodePtr lhs, const NodePtr rhs) const {
+      return keys_[lhs] == keys_[rhs];
+    }
+   private:
+    const KeyContainer& keys_;
+  };
+
+  RadixTrie() : peak_bytes_(0) { }
+  virtual ~RadixTrie() { }
+
+  /// Matches [begin, end) an edge at a time
+  bool Match(const Char* begin, const Char* end, Value* value = NULL) const {
+    if (nodes_.empty()) {
+      return false;
+    }
+    NodePtr node = Root();
+    while (begin != end) {
+      const Node& unit = nodes_[node];
+      std::size_t i = FindChild(unit, *begin);
+      if (i == unit.nchild) {
+        return false;
+      }
+      node = unit.child + static_cast<NodePtr>(i);
+      const Node& child = nodes_[node];
+      ++begin;
+      std::size_t rest = child.length - 1;
+      if (rest) {
+        if (static_cast<std::size_t>(end - begin) < rest
+            || std::char_traits<Char>::compare(&pool_[child.tail], begin, rest) != 0) {
+          return false;
+        }
+        begin += rest;
+      }
+    }
+    if (nodes_[node].value == 0) {
+      return false;
+    }
+    if (value) {
+      *value = values_[nodes_[node].value - 1];
+    }
+    return true;
+  }
+
+  bool Match(const Char* begin, std::size_t length, Value* value = NULL) const {
+    return Match(begin, begin + length, value);
+  }
+
+  bool Match(const Char* begin, Value* value = NULL) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return Match(begin, begin + length, value);
+  }
+
+  virtual std::size_t NodeSize() const {
+    return sizeof(Node) + sizeof(Char);
+  }
+
+  virtual std::size_t NumNodes() const {
+    return nodes_.size();
+  }
+
+  virtual std::string Name() const {
+    return "RadixTrie";
+  }
+
+  virtual MemoryStats MemoryUsage() const {
+    MemoryStats stats;
+    // the padding of firsts_ is not part of any node
+    std::size_t padding = (firsts_.size() - nodes_.size()) * sizeof(Char);
+    stats.nodes = SizeInBytes(nodes_) + SizeInBytes(firsts_) - padding;
+    stats.values = SizeInBytes(values_);
+    stats.extra = SizeInBytes(pool_) + padding;
+    stats.build = CapacityInBytes(kids_) + CapacityInBytes(keys_) + CapacityInBytes(inserted_);
+    stats.slack = SlackInBytes(nodes_) + SlackInBytes(firsts_) + SlackInBytes(pool_)
+        + SlackInBytes(values_);
+    stats.peak = peak_bytes_;
+    if (nodes_.size() > Root()) {
+      // every node but Null is used
+      stats.fill_ratio = static_cast<double>(nodes_.size() - Root()) / nodes_.size();
+    }
+    return stats;
+  }
+
+  virtual void ShrinkToFit() {
+    if (!this->IsBuilt()) {
+      return;
+    }
+    KidContainer().swap(kids_);
+    KeyContainer().swap(keys_);
+    ValueContainer().swap(inserted_);
+    NodeContainer(nodes_).swap(nodes_);
+    LabelContainer(firsts_).swap(firsts_);
+    LabelContainer(pool_).swap(pool_);
+    ValueContainer(values_).swap(values_);
+  }
+
+  virtual std::string ToString() const {
+    std::stringstream ss;
+    for (std::size_t i = Root(); i < nodes_.size(); ++i) {
+      ss << "[" << i << "] " << nodes_[i].ToString() << " first="
+          << static_cast<uint64_t>(static_cast<UChar>(firsts_[i])) << "\n";
+    }
+    return ss.str();
+  }
+
+ protected:
+  virtual NodePtr Root() const {
+    return 1;
+  }
+
+  virtual NodePtr Child(NodePtr parent, Char label) const {
+    if (parent & kEdgeFlag) {
+      NodePtr pos = parent & ~kEdgeFlag;
+      if (pool_[pos] != label) {
+        return Null();
+      }
+      return EdgeStep(pos + 1);
+    }
+    const Node& unit = nodes_[parent];
+    std::size_t i = FindChild(unit, label);
+    if (i == unit.nchild) {
+      return Null();
+    }
+    return Enter(unit.child + static_cast<NodePtr>(i));
+  }
+
+  virtual bool IsNull(NodePtr p) const {
+    return p == Null();
+  }
+
+  virtual bool IsFinal(NodePtr node) const {
+    return !(node & kEdgeFlag) && nodes_[node].value != 0;
+  }
+
+  virtual const Value* GetValue(NodePtr node) const {
+    if (!IsFinal(node)) {
+      return NULL;
+    }
+    return &values_[nodes_[node].value - 1];
+  }
+
+  virtual NodePtr NextChild(NodePtr parent, std::size_t* next, Char* label) const {
+    if (parent & kEdgeFlag) {
+      if (*next != 0) {
+        return Null();
+      }
+      NodePtr pos = parent & ~kEdgeFlag;
+      *next = 1;
+      *label = pool_[pos];
+      return EdgeStep(pos + 1);
+    }
+    const Node& unit = nodes_[parent];
+    if (*next >= unit.nchild) {
+      return Null();
+    }
+    NodePtr child = unit.child + static_cast<NodePtr>((*next)++);
+    *label = firsts_[child];
+    return Enter(child);
+  }
+
+  virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
+    if (begin != end) {
+      std::size_t length = static_cast<std::size_t>(std::distance(begin, end));
+      keys_.push_back(Key(begin, length));
+      inserted_.push_back(value);
+    }
+  }
+
+  virtual void DoBuild(bool sort = true) {
+    kids_.clear();
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+      kids_.push_back(static_cast<NodePtr>(i));
+    }
+    if (sort) {
+      std::sort(kids_.begin(), kids_.end(), KeyIdLess(keys_));
+      typename KidContainer::iterator new_end = std::unique(kids_.begin(), kids_.end(),
+                                                            KeyIdEqual(keys_));
+      kids_.resize(static_cast<std::size_t>(std::distance(kids_.begin(), new_end)));
+    }
+    ClearNodes();
+    while (nodes_.size() <= Root()) {
+      nodes_.push_back(Node());
+      firsts_.push_back(NullChar());
+    }
+    pool_.push_back(NullChar());  // tail 0 is no tail
+    BuildNode(0, Root(), 0, kids_.size());
+    // FindLabel may read a vector past the last sibling
+    firsts_.resize(nodes_.size() + LabelScan<sizeof(Char)>::kPadding, NullChar());
+    peak_bytes_ = CapacityInBytes(nodes_) + CapacityInBytes(firsts_) + CapacityInBytes(pool_)
+        + CapacityInBytes(values_) + CapacityInBytes(kids_) + CapacityInBytes(keys_)
+        + CapacityInBytes(inserted_);
+
+    // release keys_
+    KeyContainer().swap(keys_);
+    ValueContainer().swap(inserted_);
+  }
+
+  virtual void DoClear() {
+    peak_bytes_ = 0;
+    ClearNodes();
+    kids_.clear();
+    keys_.clear();
+    inserted_.clear();
+  }
+
+ private:
+  template<typename> friend class StaticTrie;
+
+  /// Flags a node pointer inside an edge, the rest being a pool position
+  static const NodePtr kEdgeFlag = static_cast<NodePtr>(1) << (sizeof(NodePtr) * 8 - 1);
+
+  /// Chars taken by the node stored after a span of the pool
+  static const std::size_t kNodeChars = (sizeof(NodePtr) + sizeof(Char) - 1) / sizeof(Char);
+
+  /// Fan-outs up to this many labels are scanned rather than binary searched
+  static const std::size_t kScanLabels = 32;
+
+  /// Orders labels as unsigned, like Key
+  struct LabelLess {
+    bool operator()(Char lhs, Char rhs) const {
+      return static_cast<UChar>(lhs) < static_cast<UChar>(rhs);
+    }
+  };
+
+  static Char NullChar() {
+    return 0;
+  }
+
+  static NodePtr Null() {
+    return 0;
+  }
+
+  /// The index among the children of unit of the one whose edge starts with label, or nchild
+  std::size_t FindChild(const Node& unit, Char label) const {
+    const Char* begin = &firsts_[0] + unit.child;
+    std::size_t n = unit.nchild;
+    if (n <= kScanLabels) {
+      return FindLabel(begin, n, label);
+    }
+    std::size_t i = static_cast<std::size_t>(std::lower_bound(begin, begin + n, label,
+                                                              LabelLess()) - begin);
+    return i < n && begin[i] == label ? i : n;
+  }
+
+  /// The pointer after the first label of the edge into node
+  NodePtr Enter(NodePtr node) const {
+    return nodes_[node].length > 1 ? nodes_[node].tail | kEdgeFlag : node;
+  }
+
+  /// The pointer to pos inside an edge, or the node at its end
+  NodePtr EdgeStep(NodePtr pos) const {
+    if (pool_[pos] != NullChar()) {
+      return pos | kEdgeFlag;
+    }
+    NodePtr node = 0;
+    std::memcpy(&node, &pool_[pos + 1], sizeof(NodePtr));
+    return node;
+  }
+
+  void ClearNodes() {
+    nodes_.clear();
+    firsts_.clear();
+    pool_.clear();
+    values_.clear();
+  }
+
+  /// Appends the labels of an edge after its first, then NullChar and node
+  NodePtr AppendTail(const Key& key, std::size_t begin, std::size_t end, NodePtr node) {
+    NodePtr pos = static_cast<NodePtr>(pool_.size());
+    pool_.insert(pool_.end(), key.ptr + begin, key.ptr + end);
+    pool_.push_back(NullChar());
+    Char buf[kNodeChars] = { 0 };
+    std::memcpy(buf, &node, sizeof(NodePtr));
+    pool_.insert(pool_.end(), buf, buf + kNodeChars);
+    return pos;
+  }
+
+  /// Builds the children of parent from the keys kids_[begin, end), which share depth labels
+  void BuildNode(std::size_t depth, NodePtr parent, std::size_t begin, std::size_t end) {
+    if (begin < end && keys_[kids_[begin]].length == depth) {
+      values_.push_back(inserted_[kids_[begin]]);
+      nodes_[parent].value = static_cast<NodePtr>(values_.size());
+      ++begin;
+    }
+    std::vector<std::size_t> guards;
+    for (std::size_t i = begin; i < end; ++i) {
+      if (i == begin || keys_[kids_[i]].ptr[depth] != keys_[kids_[i - 1]].ptr[depth]) {
+        guards.push_back(i);
+      }
+    }
+    guards.push_back(end);
+    NodePtr first = static_cast<NodePtr>(nodes_.size());
+    nodes_[parent].child = first;
+    nodes_[parent].nchild = static_cast<NodePtr>(guards.size() - 1);
+    nodes_.resize(nodes_.size() + guards.size() - 1);
+    std::vector<std::size_t> depths(guards.size() - 1);
+    for (std::size_t g = 0; g + 1 < guards.size(); ++g) {
+      // the edge runs while the first and last keys agree, stopping at a NullChar
+      const Key& lo = keys_[kids_[guards[g]]];
+      const Key& hi = keys_[kids_[guards[g + 1] - 1]];
+      std::size_t stop = depth + 1;
+      while (stop < lo.length && stop < hi.length && lo.ptr[stop] == hi.ptr[stop]
+             && lo.ptr[stop] != NullChar()) {
+        ++stop;
+      }
+      NodePtr node = first + static_cast<NodePtr>(g);
+      firsts_.push_back(lo.ptr[depth]);
+      nodes_[node].length = static_cast<NodePtr>(stop - depth);
+      if (stop - depth > 1) {
+        nodes_[node].tail = AppendTail(lo, depth + 1, stop, node);
+      }
+      depths[g] = stop;
+    }
+    for (std::size_t g = 0; g + 1 < guards.size(); ++g) {
+      BuildNode(depths[g], first + static_cast<NodePtr>(g), guards[g], guards[g + 1]);
+    }
+  }
+
+  NodeContainer nodes_;
+  LabelContainer firsts_;   ///< First label of the edge into each node, padded for FindLabel
+  LabelContainer pool_;     ///< Edge labels after the first, each span followed by its node
+  ValueContainer values_;
+  KidContainer kids_;
+  KeyContainer keys_;       // Released at the end of Build
+  ValueContainer inserted_;  // Values of keys_, released at the end of Build
+  std::size_t peak_bytes_;  ///< Peak allocation of the last Build
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_RADIX_TRIE_H_
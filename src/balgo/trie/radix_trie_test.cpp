@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "trie_test_common.h"
+#include "radix_trie.h"
+#include "ternary_trie.h"
+
+namespace balgo {
+
+TEST(RadixTrie, Match) {
+  RadixTrie<char, size_t> trie;
+  TestMatch(trie);
+}
+
+TEST(RadixTrie, MatchPrefix) {
+  RadixTrie<char, size_t> trie;
+  TestMatchPrefix(trie);
+}
+
+TEST(RadixTrie, MatchPrefixVisitor) {
+  RadixTrie<char, size_t> trie;
+  TestMatchPrefixVisitor(trie);
+}
+
+TEST(RadixTrie, Segment) {
+  RadixTrie<char, size_t> trie;
+  TestSegment(trie);
+}
+
+TEST(RadixTrie, FuzzyMatch) {
+  RadixTrie<char, size_t> trie;
+  TestFuzzyMatch(trie);
+}
+
+TEST(RadixTrie, StaticTrie) {
+  RadixTrie<char, size_t> trie;
+  TestStaticTrie(trie);
+}
+
+TEST(RadixTrie, ManyKeys) {
+  RadixTrie<char, size_t> trie;
+  TestManyKeys(trie);
+  EXPECT_FALSE(trie.Insert("new", 1));
+}
+
+TEST(RadixTrie, MemoryUsage) {
+  // GenerateKeys repeats some keys, which keep a single value
+  std::vector<std::string> keys = GenerateKeys(20000);
+  RadixTrie<char, size_t> trie;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  MemoryStats stats = trie.MemoryUsage();
+  EXPECT_EQ(trie.NodeSize() * trie.NumNodes(), stats.nodes);
+  EXPECT_GT(stats.extra, 0U);
+  EXPECT_GT(stats.build, 0U);
+  EXPECT_GE(stats.peak, stats.nodes + stats.values + stats.build);
+
+  trie.ShrinkToFit();
+  MemoryStats shrunk = trie.MemoryUsage();
+  EXPECT_EQ(stats.nodes, shrunk.nodes);
+  EXPECT_EQ(0U, shrunk.build);
+  EXPECT_EQ(0U, shrunk.slack);
+  EXPECT_EQ(shrunk.nodes + shrunk.values + shrunk.extra, shrunk.Total());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.Match(keys[i].c_str())) << " key: " << keys[i];
+  }
+}
+
+TEST(RadixTrie, Paths) {
+  // long shared prefixes collapse into few nodes
+  std::vector<std::string> keys;
+  const char* hosts[] = { "http://www.example.com/", "http://www.example.org/",
+    "https://static.example.com/assets/" };
+  const char* dirs[] = { "", "docs/", "docs/api/", "images/icons/" };
+  for (size_t h = 0; h < 3; ++h) {
+    for (size_t d = 0; d < 4; ++d) {
+      for (int f = 0; f < 20; ++f) {
+        keys.push_back(std::string(hosts[h]) + dirs[d] + "page" + static_cast<char>('a' + f)
+                       + ".html");
+      }
+    }
+  }
+  RadixTrie<char, size_t> trie;
+  TernaryTrie<char, size_t> ternary;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+    ternary.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  ternary.Build();
+  // at most a branch and a leaf per key, plus Null and Root
+  EXPECT_LE(trie.NumNodes(), 2 * keys.size() + 2);
+  EXPECT_LT(trie.NumNodes() * 5, ternary.NumNodes());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 0;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(i, value);
+    // stops inside an edge, then leaves it
+    EXPECT_FALSE(trie.Match(keys[i].c_str(), keys[i].size() - 2)) << " key: " << keys[i];
+    std::string other(keys[i]);
+    other[other.size() - 3] = 'x';
+    EXPECT_FALSE(trie.Match(other.c_str())) << " key: " << other;
+    std::string longer(keys[i] + "l");
+    EXPECT_FALSE(trie.Match(longer.c_str())) << " key: " << longer;
+  }
+  EXPECT_FALSE(trie.Match("http://www.example.com/"));
+  EXPECT_FALSE(trie.Match(""));
+}
+
+TEST(RadixTrie, PrefixKeys) {
+  // keys ending inside the edges of others split them
+  const char* keys[] = { "abcdef", "abc", "abcdefgh", "a", "abd", "b" };
+  const size_t n = sizeof(keys) / sizeof(keys[0]);
+  RadixTrie<char, size_t> trie;
+  for (size_t i = 0; i < n; ++i) {
+    trie.Insert(keys[i], i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < n; ++i) {
+    size_t value = n;
+    EXPECT_TRUE(trie.Match(keys[i], &value)) << " key: " << keys[i];
+    EXPECT_EQ(i, value);
+  }
+  const char* absent[] = { "ab", "abcd", "abcdefg", "abcdefghi", "abe", "c", "bb" };
+  for (size_t i = 0; i < sizeof(absent) / sizeof(absent[0]); ++i) {
+    EXPECT_FALSE(trie.Match(absent[i])) << " key: " << absent[i];
+  }
+  std::vector<size_t> found;
+  EXPECT_EQ(4U, trie.MatchPrefix("abcdefghij", &found));
+  std::vector<size_t> expected = { 3, 1, 0, 2 };
+  EXPECT_EQ(expected, found);
+}
+
+TEST(RadixTrie, NullChars) {
+  // NullChar labels never sit inside an edge
+  std::string keys[] = { std::string("ab\0cd", 5), std::string("ab\0ce", 5),
+    std::string("\0\0x", 3), "ab" };
+  RadixTrie<char, size_t> trie;
+  for (size_t i = 0; i < 4; ++i) {
+    trie.Insert(keys[i].data(), keys[i].size(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < 4; ++i) {
+    size_t value = 4;
+    EXPECT_TRUE(trie.Match(keys[i].data(), keys[i].size(), &value)) << " key: " << i;
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(trie.Match("ab\0c", 4));
+  EXPECT_FALSE(trie.Match("\0\0", 2));
+}
+
+}  // namespace balgo
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_SHARED_TRIE_H_
+#define BALGO_TRIE_SHARED_TRIE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace balgo {
+
+/**
+ * @brief Handle to a dictionary that is replaced while it is being read
+ *
+ * A reader takes a Snapshot, which pins the current version of T until it
+ * goes out of scope; taking and releasing one is a few atomic operations
+ * and never waits. A writer builds the next version on its own, e.g. a
+ * DaTrie, TernaryTrie or AhoCorasick filled with Insert and Build, and hands
+ * it to Publish. Publish swaps it in atomically, then waits until no
+ * snapshot pins the previous version and deletes it, in the manner of RCU.
+ * Writers are serialized; a long-held snapshot only delays the writer.
+ *
+ * Readers count themselves in two generations of counters, each spread over
+ * kShards cache lines to keep the threads off each other's lines. Publish
+ * moves new readers to the other generation before waiting for the old one
+ * to drain, and does so twice so that both have drained since the swap.
+ *
+ * @note Usage:
+ *   SharedTrie<DaTrie<char, uint32_t> > shared(first);
+ *   // reader threads
+ *   SharedTrie<DaTrie<char, uint32_t> >::Snapshot snapshot(shared);
+ *   snapshot->Match(key, &value);
+ *   // writer thread
+ *   DaTrie<char, uint32_t>* next = new DaTrie<char, uint32_t>;
+ *   ...
+ *   next->Build();
+ *   shared.Publish(next);
+ */
+template<typename T>
+class SharedTrie {
+ public:
+  /// Pins the current version for the lifetime of the snapshot
+  class Snapshot {
+   public:
+    explicit Snapshot(const SharedTrie& shared)
+        : counter_(shared.Enter()),
+          trie_(shared.current_.load()) {
+    }
+    ~Snapshot() {
+      counter_->fetch_sub(1, std::memory_order_release);
+    }
+
+    /// The pinned version, NULL if nothing has been published
+    const T* get() const {
+      return trie_;
+    }
+    const T& operator*() const {
+      return *trie_;
+    }
+    const T* operator->() const {
+      return trie_;
+    }
+
+   private:
+    Snapshot(const Snapshot&);
+    void operator=(const Snapshot&);
+
+    std::atomic<std::size_t>* counter_;
+    const T* trie_;
+  };
+
+  /// Starts with trie, which may be NULL, and takes ownership of it
+  explicit SharedTrie(T* trie = NULL)
+      : current_(trie),
+        generation_(0),
+        version_(trie ? 1 : 0) {
+    for (std::size_t i = 0; i < kShards; ++i) {
+      shards_[i].counters[0].store(0);
+      shards_[i].counters[1].store(0);
+    }
+  }
+
+  /// Deletes the current version; no snapshot may be alive
+  ~SharedTrie() {
+    delete current_.load();
+  }
+
+  /**
+   * Replaces the current version with trie and takes ownership of it. Returns
+   * once the previous version has been deleted, i.e. after every snapshot
+   * taken before the swap has been released.
+   */
+  void Publish(T* trie) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    T* old = current_.exchange(trie);
+    ++version_;
+    Synchronize();
+    delete old;
+  }
+
+  /// Number of versions published so far, including the initial one
+  std::size_t version() const {
+    return version_.load();
+  }
+
+ private:
+  enum {
+    kShards = 16,     ///< Reader counters per generation
+    kCacheLine = 64,
+  };
+
+  struct Shard {
+    std::atomic<std::size_t> counters[2];  ///< Readers per generation
+    char padding[kCacheLine - 2 * sizeof(std::atomic<std::size_t>)];
+  };
+
+  SharedTrie(const SharedTrie&);
+  void operator=(const SharedTrie&);
+
+  /// Counts a reader in the current generation and returns its counter
+  std::atomic<std::size_t>* Enter() const {
+    std::atomic<std::size_t>* counter =
+        &shards_[ShardOf()].counters[generation_.load(std::memory_order_relaxed)];
+    counter->fetch_add(1);
+    return counter;
+  }
+
+  /// Waits until the readers of both generations have drained once
+  void Synchronize() {
+    for (int i = 0; i < 2; ++i) {
+      std::size_t gen = generation_.load();
+      generation_.store(gen ^ 1);
+      while (Readers(gen)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  std::size_t Readers(std::size_t gen) const {
+    std::size_t cnt = 0;
+    for (std::size_t i = 0; i < kShards; ++i) {
+      cnt += shards_[i].counters[gen].load();
+    }
+    return cnt;
+  }
+
+  /// Spreads the threads over the shards, round robin by first use
+  static std::size_t ShardOf() {
+    static std::atomic<std::size_t> s_next(0);
+    static thread_local std::size_t s_shard = s_next.fetch_add(1) % kShards;
+    return s_shard;
+  }
+
+  mutable Shard shards_[kShards];
+  std::atomic<T*> current_;
+  std::atomic<std::size_t> generation_;
+  std::atomic<std::size_t> version_;
+  std::mutex mutex_;  ///< Serializes the writers
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_SHARED_TRIE_H_
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#include <omp.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "trie_test_common.h"
+#include "da_trie.h"
+#include "shared_trie.h"
+#include "ternary_trie.h"
+
+namespace balgo {
+
+/// Counts the live instances
+struct Tracked {
+  explicit Tracked(int i) : id(i) { ++s_alive; }
+  ~Tracked() { --s_alive; }
+  int id;
+  static std::atomic<int> s_alive;
+};
+
+std::atomic<int> Tracked::s_alive(0);
+
+/// Maps every key to version
+DaTrie<char, size_t>* NewVersion(const std::vector<std::string>& keys, size_t version) {
+  DaTrie<char, size_t>* trie = new DaTrie<char, size_t>;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), version);
+  }
+  trie->Build();
+  return trie;
+}
+
+TEST(SharedTrie, Publish) {
+  SharedTrie<TernaryTrie<char, size_t> > shared;
+  EXPECT_EQ(0U, shared.version());
+  {
+    SharedTrie<TernaryTrie<char, size_t> >::Snapshot snapshot(shared);
+    EXPECT_TRUE(snapshot.get() == NULL);
+  }
+
+  TernaryTrie<char, size_t>* trie = new TernaryTrie<char, size_t>;
+  trie->Insert("abc", 1);
+  trie->Build();
+  shared.Publish(trie);
+  EXPECT_EQ(1U, shared.version());
+  SharedTrie<TernaryTrie<char, size_t> >::Snapshot snapshot(shared);
+  size_t value = 0;
+  EXPECT_TRUE(snapshot->Match("abc", &value));
+  EXPECT_EQ(1U, value);
+  EXPECT_FALSE((*snapshot).Match("ab"));
+}
+
+TEST(SharedTrie, Reclaim) {
+  {
+    SharedTrie<Tracked> shared(new Tracked(1));
+    EXPECT_EQ(1, Tracked::s_alive);
+    shared.Publish(new Tracked(2));
+    EXPECT_EQ(1, Tracked::s_alive);
+
+    // the old version outlives the swap while a snapshot pins it
+    SharedTrie<Tracked>::Snapshot* snapshot = new SharedTrie<Tracked>::Snapshot(shared);
+    EXPECT_EQ(2, (*snapshot)->id);
+#pragma omp parallel sections num_threads(2)
+    {
+#pragma omp section
+      shared.Publish(new Tracked(3));
+#pragma omp section
+      {
+        while (shared.version() < 3) {
+          std::this_thread::yield();
+        }
+        SharedTrie<Tracked>::Snapshot latest(shared);
+        EXPECT_EQ(3, latest->id);
+        EXPECT_EQ(2, (*snapshot)->id);
+        EXPECT_EQ(2, Tracked::s_alive);
+        delete snapshot;
+      }
+    }
+    EXPECT_EQ(1, Tracked::s_alive);
+  }
+  EXPECT_EQ(0, Tracked::s_alive);
+}
+
+TEST(SharedTrie, ReadWhilePublishing) {
+  std::vector<std::string> keys = GenerateKeys(2000);
+  const size_t kVersions = 20;
+  SharedTrie<DaTrie<char, size_t> > shared(NewVersion(keys, 0));
+  std::atomic<bool> done(false);
+  std::atomic<size_t> errors(0);
+  std::atomic<size_t> reads(0);
+#pragma omp parallel num_threads(4)
+  {
+    if (omp_get_thread_num() == 0) {
+      while (reads == 0 && omp_get_num_threads() > 1) {
+        std::this_thread::yield();
+      }
+      for (size_t v = 1; v < kVersions; ++v) {
+        shared.Publish(NewVersion(keys, v));
+      }
+      done = true;
+    } else {
+      while (!done) {
+        // every key of one snapshot maps to the same version
+        SharedTrie<DaTrie<char, size_t> >::Snapshot snapshot(shared);
+        size_t version = 0;
+        snapshot->Match(keys[0].c_str(), &version);
+        for (size_t i = 0; i < keys.size(); i += 7) {
+          size_t value = kVersions;
+          if (!snapshot->Match(keys[i].c_str(), &value) || value != version) {
+            ++errors;
+          }
+        }
+        ++reads;
+      }
+    }
+  }
+  EXPECT_EQ(0U, errors.load());
+  EXPECT_GT(reads.load(), 0U);
+  EXPECT_EQ(kVersions, shared.version());
+  SharedTrie<DaTrie<char, size_t> >::Snapshot snapshot(shared);
+  size_t value = 0;
+  EXPECT_TRUE(snapshot->Match(keys[1].c_str(), &value));
+  EXPECT_EQ(kVersions - 1, value);
+}
+
+}  // namespace balgo
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+#ifndef BALGO_TRIE_STATIC_TRIE_H_
+#define BALGO_TRIE_STATIC_TRIE_H_
+
+#include <cstddef>
+
+#include "trie_lookup.h"
+
+namespace balgo {
+
+/**
+ * @brief Statically dispatched view of a built Trie
+ *
+ * Trie walks the nodes through virtual calls, one per input character. This
+ * view forwards the node primitives to Impl with qualified names instead, so
+ * the compiler sees the concrete step and can inline it into the loops of
+ * TrieLookup, which are the same as those of Trie. Impl must derive from Trie
+ * and befriend StaticTrie, as the tries here do. The view does not own
+ * the trie, which must outlive it and stay unchanged while it is used.
+ *
+ * @note Usage:
+ *   DaTrie<char, uint32_t> trie;
+ *   ...
+ *   trie.Build();
+ *   StaticTrie<DaTrie<char, uint32_t> > view(trie);
+ *   view.Match("abc", &value);
+ */
+template<typename Impl>
+class StaticTrie : public TrieLookup<StaticTrie<Impl>, typename Impl::CharType,
+                                     typename Impl::ValueType, typename Impl::NodePtrType> {
+ public:
+  typedef typename Impl::CharType Char;
+  typedef typename Impl::ValueType Value;
+  typedef typename Impl::NodePtrType NodePtr;
+
+  explicit StaticTrie(const Impl& trie)
+      : trie_(trie) {
+  }
+
+  const Impl& trie() const {
+    return trie_;
+  }
+
+ private:
+  friend class TrieLookup<StaticTrie, Char, Value, NodePtr>;
+
+  NodePtr Root() const {
+    return trie_.Impl::Root();
+  }
+
+  NodePtr Child(NodePtr parent, Char label) const {
+    return trie_.Impl::Child(parent, label);
+  }
+
+  bool IsNull(NodePtr p) const {
+    return trie_.Impl::IsNull(p);
+  }
+
+  bool IsFinal(NodePtr p) const {
+    return trie_.Impl::IsFinal(p);
+  }
+
+  const Value* GetValue(NodePtr p) const {
+    return trie_.Impl::GetValue(p);
+  }
+
+  const Impl& trie_;
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_STATIC_TRIE_H_
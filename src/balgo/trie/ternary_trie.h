@@ -30,10 +30,13 @@
 #include <algorithm>
 #include <deque>
 #include <functional>
+#include <queue>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "label_scan.h"
+#include "memory_stats.h"
 #include "trie_traits.h"
 #include "trie.h"
 
@@ -56,16 +59,24 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
   typedef std::vector<Key> KeyContainer;
   typedef std::vector<NodePtr> KidContainer;
   typedef std::vector<Value> ValueContainer;
+  typedef std::vector<Char> LabelContainer;
+  typedef uint32_t Score;
+  typedef std::vector<Score> ScoreContainer;
+
+  /// A completion found by TopK
+  struct TopHit {
+    Value value;
+    Score score;
+  };
 
+  /// The labels are kept apart in labels_, so the labels of siblings are contiguous
   struct Node {
     NodePtr child;
-    Char label;
     UChar nchild;
     bool final;
     bool sibling;
     Node()
         : child(Null()),
-          label(NullChar()),
           nchild(0),
           final(false),
           sibling(false) {
@@ -78,8 +89,7 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     }
     std::string ToString() const {
       std::stringstream ss;
-      ss << this << "(child=" << child <<  ", label=";
-      ss << HexString(static_cast<UChar>(label)) << ", nchild="
+      ss << this << "(child=" << child << ", nchild="
           << static_cast<uint32_t>(nchild) << ", sibling=" << sibling << ", final=" << final
           << ")";
       return ss.str();
@@ -149,10 +159,11 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     KeyContainer& keys_;
   };
 
+  TernaryTrie() : peak_bytes_(0) { }
   virtual ~TernaryTrie() { }
 
   virtual std::size_t NodeSize() const {
-    return sizeof(Node);
+    return sizeof(Node) + sizeof(Char);
   }
 
   virtual std::size_t NumNodes() const {
@@ -163,10 +174,189 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     return "TernaryTrie";
   }
 
+  virtual MemoryStats MemoryUsage() const {
+    MemoryStats stats;
+    // the padding of labels_ is not part of any node
+    std::size_t padding = (labels_.size() - units_.size()) * sizeof(Char);
+    stats.nodes = SizeInBytes(units_) + SizeInBytes(labels_) - padding + SizeInBytes(scores_);
+    stats.extra = padding;
+    stats.values = SizeInBytes(values_);
+    stats.build = CapacityInBytes(kids_) + CapacityInBytes(keys_);
+    stats.slack = SlackInBytes(units_) + SlackInBytes(labels_) + SlackInBytes(values_)
+        + SlackInBytes(scores_);
+    stats.peak = peak_bytes_;
+    if (units_.size() > Root()) {
+      // every unit but Null is used
+      stats.fill_ratio = static_cast<double>(units_.size() - Root()) / units_.size();
+    }
+    return stats;
+  }
+
+  virtual void ShrinkToFit() {
+    if (!this->IsBuilt()) {
+      return;
+    }
+    KidContainer().swap(kids_);
+    KeyContainer().swap(keys_);
+    NodeContainer(units_).swap(units_);
+    LabelContainer(labels_).swap(labels_);
+    ValueContainer(values_).swap(values_);
+    ScoreContainer(scores_).swap(scores_);
+  }
+
+  /**
+   * Scores every key by score_of(value) and keeps for every node the best
+   * score below it, which TopK needs. Call it after Build; Clear drops
+   * the scores.
+   */
+  template<typename ScoreOf>
+  void BuildScores(ScoreOf score_of) {
+    scores_.assign(units_.size(), 0);
+    // children are laid out after their parent, so a reverse pass sees them first
+    for (std::size_t i = units_.size(); i-- > Root();) {
+      const Node& unit = units_[i];
+      if (unit.nchild == 0) {
+        if (i != Root()) {
+          scores_[i] = score_of(values_[unit.GetValueIndex()]);
+        }
+        continue;
+      }
+      const Score* first = &scores_[unit.child];
+      scores_[i] = *std::max_element(first, first + unit.nchild);
+    }
+  }
+
+  /// Scores every key by its value
+  void BuildScores() {
+    BuildScores(ValueScore());
+  }
+
+  bool HasScores() const {
+    return !scores_.empty();
+  }
+
+  /**
+   * Finds the k best scored keys starting with [begin, end), best first and
+   * in node order among equal scores, which is key order unless the trie was
+   * relaid out. The search is best first on the
+   * subtree maxima of BuildScores, so it expands O(k * depth) nodes rather
+   * than every completion.
+   * @return the number of keys found, 0 without BuildScores
+   */
+  template<typename Hits>
+  std::size_t TopK(const Char* begin, const Char* end, std::size_t k, Hits* hits,
+                   bool clear = true) const {
+    if (clear) hits->clear();
+    if (scores_.empty() || k == 0) {
+      return 0;
+    }
+    NodePtr node = Root();
+    for (; begin != end && !IsNull(node); ++begin) {
+      node = Child(node, *begin);
+    }
+    if (IsNull(node) || units_[node].nchild == 0) {
+      return 0;
+    }
+    std::priority_queue<TopEntry> queue;
+    queue.push(TopEntry(scores_[node], node));
+    std::size_t cnt = 0;
+    while (!queue.empty() && cnt < k) {
+      NodePtr top = queue.top().node;
+      queue.pop();
+      const Node& unit = units_[top];
+      if (unit.nchild == 0) {
+        // a value unit: nothing left in the queue scores higher
+        TopHit hit = { values_[unit.GetValueIndex()], scores_[top] };
+        hits->push_back(hit);
+        ++cnt;
+        continue;
+      }
+      for (NodePtr child = unit.child; child < unit.child + unit.nchild; ++child) {
+        queue.push(TopEntry(scores_[child], child));
+      }
+    }
+    return cnt;
+  }
+
+  template<typename Hits>
+  std::size_t TopK(const Char* begin, std::size_t length, std::size_t k, Hits* hits,
+                   bool clear = true) const {
+    return TopK(begin, begin + length, k, hits, clear);
+  }
+
+  template<typename Hits>
+  std::size_t TopK(const Char* begin, std::size_t k, Hits* hits, bool clear = true) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return TopK(begin, begin + length, k, hits, clear);
+  }
+
+  /**
+   * Renumbers the units so that the nodes the n sample queries visit most
+   * come first. Child ranges are laid out again, best first by visits and
+   * then depth first, so the hot part of the trie shares cache lines and
+   * pages while the paths of the unvisited keys stay together. Lookups give
+   * the same results; scores are kept.
+   * @return whether the units were relaid out
+   */
+  bool Relayout(const Char* const* queries, const std::size_t* lengths, std::size_t n) {
+    if (!this->IsBuilt() || units_.size() <= Root()) {
+      return false;
+    }
+    std::vector<uint32_t> visits(units_.size());
+    this->CountVisits(queries, lengths, n, &visits);
+    NodeContainer units(Root() + 1);
+    LabelContainer labels(Root() + 1, NullChar());
+    KidContainer old_of(Root() + 1, Null());  // old index of every new unit
+    units[Root()] = units_[Root()];
+    old_of[Root()] = Root();
+    std::priority_queue<RelayoutEntry> queue;
+    std::size_t order = 0;
+    queue.push(RelayoutEntry(visits[Root()], order++, Root()));
+    while (!queue.empty()) {
+      NodePtr node = queue.top().node;
+      queue.pop();
+      const Node& unit = units_[old_of[node]];
+      NodePtr first = static_cast<NodePtr>(units.size());
+      for (NodePtr i = 0; i < unit.nchild; ++i) {
+        units.push_back(units_[unit.child + i]);
+        labels.push_back(labels_[unit.child + i]);
+        old_of.push_back(unit.child + i);
+      }
+      if (unit.nchild) {
+        units[node].child = first;
+      }
+      // the value unit of a final node keeps its value index
+      for (NodePtr i = unit.final; i < unit.nchild; ++i) {
+        queue.push(RelayoutEntry(visits[unit.child + i], order++, first + i));
+      }
+    }
+    if (!scores_.empty()) {
+      ScoreContainer scores(units.size());
+      for (std::size_t i = Root(); i < units.size(); ++i) {
+        scores[i] = scores_[old_of[i]];
+      }
+      scores_.swap(scores);
+    }
+    labels.resize(units.size() + LabelScan<sizeof(Char)>::kPadding, NullChar());
+    units_.swap(units);
+    labels_.swap(labels);
+    return true;
+  }
+
+  /// Relays out for n null-terminated queries, see above
+  bool Relayout(const Char* const* queries, std::size_t n) {
+    std::vector<std::size_t> lengths(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      lengths[i] = std::char_traits<Char>::length(queries[i]);
+    }
+    return Relayout(queries, n ? &lengths[0] : NULL, n);
+  }
+
   virtual std::string ToString() const {
     std::stringstream ss;
     for (std::size_t i = Root(); i < units_.size(); ++i) {
-      ss << "[" << i << "] " << units_[i].ToString() << "\n";
+      ss << "[" << i << "] " << units_[i].ToString() << " label=" << HexString(labels_[i])
+          << "\n";
     }
     return ss.str();
   }
@@ -183,12 +373,17 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     const Node& unit = units_[parent];
     NodePtr lo = unit.child + unit.final;
     NodePtr hi = unit.child + unit.nchild;
+    if (hi - lo <= kScanLabels) {
+      // one or two vector compares beat the branches of a binary search
+      NodePtr i = static_cast<NodePtr>(FindLabel(&labels_[lo], hi - lo, label));
+      return lo + i < hi ? lo + i : Null();
+    }
     while (lo < hi) {
       NodePtr mid = lo + (hi - lo) / 2;
-      if (units_[mid].label == label) {
+      if (labels_[mid] == label) {
         return mid;
       }
-      if (cmp_(units_[mid].label, label)) {
+      if (cmp_(labels_[mid], label)) {
         lo = mid + 1;
       } else {
         hi = mid;
@@ -213,6 +408,25 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     return NULL;
   }
 
+  virtual NodePtr NextChild(NodePtr parent, std::size_t* next, Char* label) const {
+    if (!HasRealChild(parent)) {
+      return Null();
+    }
+    const Node& unit = units_[parent];
+    std::size_t i = unit.final + *next;
+    if (i >= unit.nchild) {
+      return Null();
+    }
+    ++*next;
+    NodePtr child = unit.child + static_cast<NodePtr>(i);
+    *label = labels_[child];
+    return child;
+  }
+
+  virtual bool LabelLess(Char lhs, Char rhs) const {
+    return cmp_(lhs, rhs);
+  }
+
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) {
     if (begin != end) {
       std::size_t length = static_cast<std::size_t>(std::distance(begin, end));
@@ -236,24 +450,36 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
 
     // init m_root
     units_.clear();
+    labels_.clear();
+    scores_.clear();
     while (units_.size() <= Root()) {
       units_.push_back(Node());
+      labels_.push_back(NullChar());
     }
 
     BuildNode(0, Root(), 0, kids_.size());
+    // FindLabel may read a vector past the last sibling
+    labels_.resize(units_.size() + LabelScan<sizeof(Char)>::kPadding, NullChar());
+    peak_bytes_ = CapacityInBytes(units_) + CapacityInBytes(labels_) + CapacityInBytes(values_)
+        + CapacityInBytes(kids_) + CapacityInBytes(keys_);
 
     // release keys_
     KeyContainer().swap(keys_);
   }
 
   virtual void DoClear() {
+    peak_bytes_ = 0;
     units_.clear();
+    labels_.clear();
     values_.clear();
+    scores_.clear();
     kids_.clear();
     keys_.clear();
   }
 
  private:
+  template<typename> friend class StaticTrie;
+
   static Char NullChar() {
     return 0;
   }
@@ -262,6 +488,37 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
     return 0;
   }
 
+  /// Fan-outs up to this many labels are scanned rather than binary searched
+  static const NodePtr kScanLabels = 32;
+
+  /// The default score of a key, its value
+  struct ValueScore {
+    Score operator()(const Value& value) const {
+      return static_cast<Score>(value);
+    }
+  };
+
+  /// A node queued by Relayout; the queue pops most visits, then last queued
+  struct RelayoutEntry {
+    uint32_t visits;
+    std::size_t order;
+    NodePtr node;
+    RelayoutEntry(uint32_t v, std::size_t o, NodePtr n) : visits(v), order(o), node(n) { }
+    bool operator<(const RelayoutEntry& rhs) const {
+      return visits < rhs.visits || (visits == rhs.visits && order < rhs.order);
+    }
+  };
+
+  /// A node queued by TopK; the queue pops high scores, then low nodes
+  struct TopEntry {
+    Score score;
+    NodePtr node;
+    TopEntry(Score s, NodePtr n) : score(s), node(n) { }
+    bool operator<(const TopEntry& rhs) const {
+      return score < rhs.score || (score == rhs.score && node > rhs.node);
+    }
+  };
+
   // debug
   template<typename T>
   static std::string HexString(T x) {
@@ -299,7 +556,7 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
         }
         prev_node = units_.size();
         units_.push_back(Node());
-        units_.back().label = label;
+        labels_.push_back(label);
         units_[parent].nchild++;
       }
     }
@@ -318,14 +575,17 @@ class TernaryTrie : public Trie<Char, Value, NodePtr> {
   }
 
   Char Label(const NodePtr node) const {
-    return units_[node].label;
+    return labels_[node];
   }
 
   Compare cmp_;
   NodeContainer units_;
+  LabelContainer labels_;  ///< Label of every unit, padded for FindLabel
   ValueContainer values_;
   KidContainer kids_;
   KeyContainer keys_;    // Released at the end of Build
+  ScoreContainer scores_;  ///< Best key score below every unit, see BuildScores
+  std::size_t peak_bytes_;  ///< Peak allocation of the last Build
 };
 
 }  // namespace balgo
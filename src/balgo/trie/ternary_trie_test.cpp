@@ -40,4 +40,162 @@ TEST(TernaryTrie, MatchPrefix) {
 //  TestMatchPrefix(trie);
 }
 
+TEST(TernaryTrie, MatchPrefixVisitor) {
+  TernaryTrie<char, size_t> trie;
+  TestMatchPrefixVisitor(trie);
+}
+
+TEST(TernaryTrie, Segment) {
+  TernaryTrie<char, size_t> trie;
+  TestSegment(trie);
+}
+
+TEST(TernaryTrie, MemoryUsage) {
+  TernaryTrie<char, size_t> trie;
+  TestMemoryUsage(trie);
+}
+
+TEST(TernaryTrie, WideFanOut) {
+  // fan-outs on both sides of the scan limit
+  TernaryTrie<char, size_t> trie;
+  std::vector<std::string> keys;
+  for (int first = 1; first < 200; first += 3) {
+    for (int second = 1; second <= first; second += 7) {
+      std::string key(1, static_cast<char>(first));
+      key.push_back(static_cast<char>(second));
+      keys.push_back(key);
+      keys.push_back(key.substr(0, 1));
+    }
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(trie.Match(keys[i].c_str())) << " key: " << i;
+    std::string absent(keys[i]);
+    absent[0] = static_cast<char>(absent[0] + 1);
+    EXPECT_FALSE(trie.Match(absent.c_str())) << " key: " << i;
+    absent = keys[i] + static_cast<char>(250);
+    EXPECT_FALSE(trie.Match(absent.c_str())) << " key: " << i;
+  }
+}
+
+TEST(TernaryTrie, FuzzyMatch) {
+  TernaryTrie<char, size_t> trie;
+  TestFuzzyMatch(trie, true);  // std::less<char> orders the labels
+}
+
+struct SpreadScore {
+  uint32_t operator()(size_t value) const {
+    return static_cast<uint32_t>(value * 7919 % 100003);
+  }
+};
+
+struct FewScores {
+  uint32_t operator()(size_t value) const {
+    return static_cast<uint32_t>(value % 3);
+  }
+};
+
+bool BetterHit(const std::pair<uint32_t, std::string>& lhs,
+               const std::pair<uint32_t, std::string>& rhs) {
+  return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+}
+
+template<typename ScoreOf>
+void TestTopK(ScoreOf score_of) {
+  typedef TernaryTrie<char, size_t> TrieType;
+  TrieType trie;
+  std::vector<TrieType::TopHit> hits;
+  trie.Build();
+  trie.BuildScores(score_of);
+  EXPECT_EQ(0U, trie.TopK("", 10, &hits));
+
+  std::vector<std::string> keys = GenerateKeys(5000);
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::random_shuffle(keys.begin(), keys.end());
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  EXPECT_FALSE(trie.HasScores());
+  EXPECT_EQ(0U, trie.TopK("", 10, &hits));
+  trie.BuildScores(score_of);
+  EXPECT_TRUE(trie.HasScores());
+
+  const char* kPrefixes[] = { "", "a", "ab", "ba", "abc", "zzzzzz", "q" };
+  const size_t kCounts[] = { 1, 3, 10, 100000 };
+  for (size_t i = 0; i < ARRAY_SIZE(kPrefixes); ++i) {
+    std::string prefix(kPrefixes[i]);
+    std::vector<std::pair<uint32_t, std::string> > expected;
+    for (size_t j = 0; j < keys.size(); ++j) {
+      if (keys[j].compare(0, prefix.size(), prefix) == 0) {
+        expected.push_back(std::make_pair(score_of(j), keys[j]));
+      }
+    }
+    std::sort(expected.begin(), expected.end(), BetterHit);
+    for (size_t j = 0; j < ARRAY_SIZE(kCounts); ++j) {
+      size_t n = std::min(kCounts[j], expected.size());
+      ASSERT_EQ(n, trie.TopK(prefix.c_str(), kCounts[j], &hits)) << " prefix: " << prefix;
+      ASSERT_EQ(n, hits.size());
+      for (size_t h = 0; h < n; ++h) {
+        EXPECT_EQ(expected[h].second, keys[hits[h].value]) << " prefix: " << prefix;
+        EXPECT_EQ(expected[h].first, hits[h].score) << " prefix: " << prefix;
+      }
+    }
+  }
+  EXPECT_EQ(0U, trie.TopK("a", 0, &hits));
+  EXPECT_EQ(2U, trie.TopK("a", 1, &hits, false) + trie.TopK("a", 1, &hits, false));
+  EXPECT_EQ(2U, hits.size());
+
+  trie.Clear();
+  EXPECT_FALSE(trie.HasScores());
+}
+
+TEST(TernaryTrie, TopK) {
+  TestTopK(SpreadScore());
+  TestTopK(FewScores());
+
+  TernaryTrie<char, uint32_t> trie;
+  trie.Insert("ab", 5);
+  trie.Insert("abc", 9);
+  trie.Insert("b", 7);
+  trie.Build();
+  trie.BuildScores();
+  std::vector<TernaryTrie<char, uint32_t>::TopHit> hits;
+  ASSERT_EQ(2U, trie.TopK("", 2, &hits));
+  EXPECT_EQ(9U, hits[0].value);
+  EXPECT_EQ(7U, hits[1].value);
+  ASSERT_EQ(2U, trie.TopK("ab", 5, &hits));
+  EXPECT_EQ(9U, hits[0].score);
+  EXPECT_EQ(5U, hits[1].score);
+}
+
+TEST(TernaryTrie, Relayout) {
+  TernaryTrie<char, size_t> trie;
+  TestRelayout(trie);
+
+  // the best scores stay the same
+  typedef TernaryTrie<char, size_t>::TopHit TopHit;
+  trie.BuildScores(SpreadScore());
+  std::vector<TopHit> before;
+  trie.TopK("a", 20, &before);
+  const char* sample[] = { "abc", "abc", "b" };
+  ASSERT_TRUE(trie.Relayout(sample, 3));
+  std::vector<TopHit> after;
+  ASSERT_EQ(before.size(), trie.TopK("a", 20, &after));
+  for (size_t i = 0; i < before.size(); ++i) {
+    EXPECT_EQ(before[i].value, after[i].value);
+    EXPECT_EQ(before[i].score, after[i].score);
+  }
+}
+
+TEST(TernaryTrie, StaticTrie) {
+  TernaryTrie<char, size_t> trie;
+  TestStaticTrie(trie);
+}
+
 }  // namespace balgo
@@ -27,11 +27,16 @@
 #define BALGO_TRIE_TRIE_H_
 
 #include <stdint.h>
+#include <algorithm>
 #include <cstddef>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "memory_stats.h"
+#include "trie_lookup.h"
+#include "trie_traits.h"
+
 namespace balgo {
 
 /**
@@ -40,50 +45,64 @@ namespace balgo {
  * @note Usage:
  * 1) Insert
  * 2) Build
- * 3) Match or MatchPrefix
+ * 3) Match or MatchPrefix, and Insert or Erase if updates are supported
+ *
+ * The lookups of TrieLookup dispatch the node primitives here virtually; see
+ * StaticTrie for an inlined view of a concrete implementation.
  */
 template<typename Char, typename Value, typename NodePtr = uint32_t>
-class Trie {
+class Trie : public TrieLookup<Trie<Char, Value, NodePtr>, Char, Value, NodePtr> {
  public:
+  typedef Char CharType;
+  typedef Value ValueType;
   typedef NodePtr NodePtrType;
 
-  struct MatchFunc {
-    virtual void operator()(const Value& value, std::size_t offset) {
-    }
-  };
-
-  template<typename Values>
-  struct ValueMatchFunc : public MatchFunc {
-   public:
-    ValueMatchFunc(Values* values)
-        : values_(values) {
-    }
-    virtual void operator()(const Value& value, std::size_t offset) {
-      values_->push_back(value);
-    }
-   private:
-    Values* values_;
+  /// A key found by FuzzyMatch
+  struct FuzzyHit {
+    Value value;
+    std::size_t distance;  ///< Edit distance from the query
   };
 
   Trie() : not_built_(true) { }
   virtual ~Trie() { }
 
+  /**
+   * Inserts a key. Before Build the key is collected for Build; afterwards it
+   * is added in place if the implementation supports updates.
+   * @return true if the key was inserted
+   */
   bool Insert(const Char* begin, const Char* end, const Value &value) {
-    if (not_built_) DoInsert(begin, end, value);
-    return not_built_;
+    if (not_built_) {
+      DoInsert(begin, end, value);
+      return true;
+    }
+    return DoInsertBuilt(begin, end, value);
   }
 
   bool Insert(const Char* begin, std::size_t length, const Value &value) {
-    if (not_built_) DoInsert(begin, begin + length, value);
-    return not_built_;
+    return Insert(begin, begin + length, value);
   }
 
   bool Insert(const Char* begin, const Value &value) {
-    if (not_built_) {
-      std::size_t length = std::char_traits<Char>::length(begin);
-      DoInsert(begin, begin + length, value);
-    }
-    return not_built_;
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return Insert(begin, begin + length, value);
+  }
+
+  /**
+   * Removes a key from a built Trie if the implementation supports updates.
+   * @return true if the key was found and removed
+   */
+  bool Erase(const Char* begin, const Char* end) {
+    return !not_built_ && DoErase(begin, end);
+  }
+
+  bool Erase(const Char* begin, std::size_t length) {
+    return Erase(begin, begin + length);
+  }
+
+  bool Erase(const Char* begin) {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return Erase(begin, begin + length);
   }
 
   bool Build() {
@@ -95,80 +114,105 @@ class Trie {
     return false;
   }
 
-  bool Match(const Char* begin, const Char* end, Value* value = NULL) const {
-    NodePtr p = Root();
-    for ( ; begin != end; ++begin) {
-      NodePtr child = Child(p, *begin);
-      if (IsNull(child)) return false;
-      p = child;
-    }
-    if (!IsFinal(p)) {
-      return false;
+  /**
+   * Finds the keys within max_edits insertions, deletions and substitutions
+   * of [begin, end). The trie is walked depth first with one row of the
+   * Levenshtein DP per node, restricted to the band of max_edits cells around
+   * the diagonal, and a subtree is pruned as soon as every cell of its row
+   * exceeds max_edits, so only the nodes near the query are visited.
+   * Hits are appended in the order of the keys.
+   * @return the number of keys found
+   */
+  template<typename Hits>
+  std::size_t FuzzyMatch(const Char* begin, const Char* end, std::size_t max_edits, Hits* hits,
+                         bool clear = true) const {
+    if (clear) hits->clear();
+    if (not_built_ || NumNodes() <= Root()) {
+      return 0;
     }
-    if (value) {
-      *value = *GetValue(p);
+    std::size_t width = static_cast<std::size_t>(end - begin) + 1;
+    std::size_t limit = max_edits + 1;  // distances are capped here
+    std::size_t stride = 2 * max_edits + 2;  // the band and the cell before it
+    std::vector<std::size_t> rows(width);
+    std::vector<Char> labels(stride);
+    for (std::size_t j = 0; j < width; ++j) {
+      rows[j] = std::min(j, limit);
     }
-    return true;
-  }
-
-  bool Match(const Char* begin, std::size_t length, Value* value = NULL) const {
-    return Match(begin, begin + length, value);
-  }
-
-  bool Match(const Char* begin, Value* value = NULL) const {
-    std::size_t length = std::char_traits<Char>::length(begin);
-    return Match(begin, begin + length, value);
-  }
-
-  std::size_t MatchPrefix(const Char* begin, const Char* end, MatchFunc& func) const {
     std::size_t cnt = 0;
-    NodePtr p = Root();
-    for (std::size_t offset; begin != end; ++begin, ++offset) {
-      NodePtr child = Child(p, *begin);
-      if (IsNull(child)) break;
-      p = child;
-      if (IsFinal(p)) {
+    std::vector<FuzzyFrame> frames(1, FuzzyFrame(Root()));
+    if (max_edits == 0) {
+      frames.back().num_labels = FuzzyLabels(begin, width, &rows[0], 0, 0, &labels[0]);
+    }
+    while (!frames.empty()) {
+      FuzzyFrame& frame = frames.back();
+      std::size_t depth = frames.size();
+      Char label = Char();
+      NodePtr child;
+      bool found = false;
+      if (frame.num_labels == FuzzyFrame::kAllLabels) {
+        child = NextChild(frame.node, &frame.next, &label);
+        found = !IsNull(child);
+      } else {
+        while (!found && frame.next < frame.num_labels) {
+          label = labels[(depth - 1) * stride + frame.next++];
+          child = Child(frame.node, label);
+          found = !IsNull(child);
+        }
+      }
+      if (!found) {
+        frames.pop_back();
+        continue;
+      }
+      if (rows.size() < (depth + 1) * width) {
+        rows.resize((depth + 1) * width);
+        labels.resize((depth + 1) * stride);
+      }
+      const std::size_t* prev = &rows[(depth - 1) * width];
+      std::size_t* row = &rows[depth * width];
+      // only the cells within max_edits of the diagonal can stay under limit
+      std::size_t lo = depth > max_edits ? depth - max_edits : 1;
+      std::size_t hi = std::min(depth + max_edits, width - 1);
+      row[lo - 1] = std::min(depth - (lo - 1), limit);
+      std::size_t best = row[lo - 1];
+      for (std::size_t j = lo; j <= hi; ++j) {
+        std::size_t cost = prev[j - 1] + (begin[j - 1] != label);
+        cost = std::min(cost, std::min(prev[j], row[j - 1]) + 1);
+        row[j] = std::min(cost, limit);
+        best = std::min(best, row[j]);
+      }
+      if (hi + 1 < width) {
+        row[hi + 1] = limit;
+      }
+      if (hi == width - 1 && row[hi] <= max_edits && IsFinal(child)) {
+        FuzzyHit hit = { *GetValue(child), row[hi] };
+        hits->push_back(hit);
         ++cnt;
-        func(*GetValue(p), offset);
+      }
+      if (best < max_edits) {
+        frames.push_back(FuzzyFrame(child));
+      } else if (best == max_edits) {
+        // the budget is spent: only the labels matching the query go on
+        FuzzyFrame next(child);
+        next.num_labels = FuzzyLabels(begin, width, row, lo - 1, hi, &labels[depth * stride]);
+        if (next.num_labels > 0) {
+          frames.push_back(next);
+        }
       }
     }
     return cnt;
   }
 
-  template<typename Values>
-  std::size_t MatchPrefix(const Char* begin, const Char* end, Values* values, bool clear = true) const {
-    if (values && clear) values->clear();
-    if (values) {
-      ValueMatchFunc<Values> func(values);
-      return MatchPrefix(begin, end, func);
-    } else {
-      static MatchFunc s_func;
-      return MatchPrefix(begin, end, s_func);
-    }
-  }
-
-  template<typename Values>
-  std::size_t MatchPrefix(const Char* begin, std::size_t length, Values* values, bool clear = true) const {
-    return MatchPrefix(begin, begin + length, values, clear);
-  }
-
-  template<typename Values>
-  std::size_t MatchPrefix(const Char* begin, Values* values, bool clear = true) const {
-    std::size_t length = std::char_traits<Char>::length(begin);
-    return MatchPrefix(begin, begin + length, values, clear);
-  }
-
-  std::size_t MatchPrefix(const Char* begin, const Char* end) const {
-    return MatchPrefix<DefaultValues>(begin, end, NULL, false);
-  }
-
-  std::size_t MatchPrefix(const Char* begin, std::size_t length) const {
-    return MatchPrefix<DefaultValues>(begin, begin + length, NULL, false);
+  template<typename Hits>
+  std::size_t FuzzyMatch(const Char* begin, std::size_t length, std::size_t max_edits,
+                         Hits* hits, bool clear = true) const {
+    return FuzzyMatch(begin, begin + length, max_edits, hits, clear);
   }
 
-  std::size_t MatchPrefix(const Char* begin) const {
+  template<typename Hits>
+  std::size_t FuzzyMatch(const Char* begin, std::size_t max_edits, Hits* hits,
+                         bool clear = true) const {
     std::size_t length = std::char_traits<Char>::length(begin);
-    return MatchPrefix<DefaultValues>(begin, begin + length, NULL, false);
+    return FuzzyMatch(begin, begin + length, max_edits, hits, clear);
   }
 
   void Clear() {
@@ -176,9 +220,20 @@ class Trie {
     DoClear();
   }
 
+  bool IsBuilt() const {
+    return !not_built_;
+  }
+
   virtual std::size_t NodeSize() const = 0;
   virtual std::size_t NumNodes() const = 0;
   virtual std::string Name() const = 0;
+
+  /// Returns the memory held by this Trie, component by component
+  virtual MemoryStats MemoryUsage() const = 0;
+
+  /// Frees the build-only structures and unused capacity of a built Trie
+  virtual void ShrinkToFit() = 0;
+
   virtual std::string ToString() const {
     return Name();
   }
@@ -190,18 +245,101 @@ class Trie {
   }
 
  protected:
+  friend class TrieLookup<Trie, Char, Value, NodePtr>;
+
   virtual NodePtr Root() const = 0;
   virtual NodePtr Child(NodePtr parent, Char label) const = 0;
   virtual bool IsNull(NodePtr p) const = 0;
   virtual bool IsFinal(NodePtr p) const = 0;
   virtual const Value* GetValue(NodePtr p) const = 0;
 
+  /**
+   * Enumerates the children of parent in label order, leaving out the value
+   * of a final node. *next starts at 0 and is advanced past the child found.
+   * @return the child, setting *label to its label, or Null after the last
+   */
+  virtual NodePtr NextChild(NodePtr parent, std::size_t* next, Char* label) const = 0;
+
+  /// Whether NextChild lists label lhs before rhs, by their unsigned values by default
+  virtual bool LabelLess(Char lhs, Char rhs) const {
+    typedef typename TrieTraits<Char>::UChar UChar;
+    return static_cast<UChar>(lhs) < static_cast<UChar>(rhs);
+  }
+
+  /**
+   * Counts in (*visits)[node] how many of the n queries step on each node,
+   * following the path of each query as far as it goes. visits must cover
+   * the node indices; a step to a node beyond it, e.g. into a DaTrie tail,
+   * ends the path.
+   */
+  void CountVisits(const Char* const* queries, const std::size_t* lengths, std::size_t n,
+                   std::vector<uint32_t>* visits) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      NodePtr p = Root();
+      ++(*visits)[p];
+      for (std::size_t j = 0; j < lengths[i]; ++j) {
+        p = Child(p, queries[i][j]);
+        if (IsNull(p) || p >= visits->size()) break;
+        ++(*visits)[p];
+      }
+    }
+  }
+
   virtual void DoBuild(bool sort = true) = 0;
   virtual void DoInsert(const Char* begin, const Char* end, const Value &value) = 0;
   virtual void DoClear() = 0;
 
+  /// Inserts a key into a built Trie; updates are not supported by default
+  virtual bool DoInsertBuilt(const Char* /*begin*/, const Char* /*end*/, const Value& /*value*/) {
+    return false;
+  }
+
+  /// Erases a key from a built Trie; updates are not supported by default
+  virtual bool DoErase(const Char* /*begin*/, const Char* /*end*/) {
+    return false;
+  }
+
+  /// Marks this Trie as built without DoBuild, e.g. after loading it
+  void MarkBuilt() {
+    not_built_ = false;
+  }
+
  private:
-  typedef std::vector<Value> DefaultValues;
+  /**
+   * A node on the path of FuzzyMatch and the position of its next child,
+   * either among all its children or among num_labels candidate labels
+   */
+  struct FuzzyFrame {
+    static const std::size_t kAllLabels = static_cast<std::size_t>(-1);
+    NodePtr node;
+    std::size_t next;
+    std::size_t num_labels;
+    explicit FuzzyFrame(NodePtr n) : node(n), next(0), num_labels(kAllLabels) { }
+  };
+
+  /**
+   * Collects into labels, unique and sorted by LabelLess, the query chars
+   * following the cells of row in [first, last] that hold its minimum: once
+   * a node has spent the whole budget, those are the only labels it can
+   * extend with.
+   * @return the number of labels
+   */
+  std::size_t FuzzyLabels(const Char* query, std::size_t width, const std::size_t* row,
+                          std::size_t first, std::size_t last, Char* labels) const {
+    std::size_t best = *std::min_element(row + first, row + last + 1);
+    std::size_t n = 0;
+    for (std::size_t j = first; j <= last && j + 1 < width; ++j) {
+      if (row[j] != best || std::find(labels, labels + n, query[j]) != labels + n) {
+        continue;
+      }
+      std::size_t k = n++;
+      for (; k > 0 && LabelLess(query[j], labels[k - 1]); --k) {
+        labels[k] = labels[k - 1];
+      }
+      labels[k] = query[j];
+    }
+    return n;
+  }
 
   bool not_built_;  ///< This Trie has not been built yet
 };
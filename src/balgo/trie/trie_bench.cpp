@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-16
+ */
+
+/**
+ * @brief Benchmarks of the Trie implementations
+ *
+ * Usage: trie_bench [num_keys ...]
+ */
+
+#include <stdint.h>
+#include <omp.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+#include <vector>
+
+#include "da_trie.h"
+#include "da_trie_builder.h"
+#include "louds_trie.h"
+#include "radix_trie.h"
+#include "shared_trie.h"
+#include "static_trie.h"
+#include "ternary_trie.h"
+
+namespace {
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+uint64_t NextRandom(uint64_t* seed) {
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+/// Dictionary-like keys: 3-16 lowercase letters, skewed towards a few letters
+std::vector<std::string> GenerateKeys(std::size_t n) {
+  std::vector<std::string> keys(n);
+  uint64_t seed = 88172645463325252ULL;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t length = 3 + static_cast<std::size_t>(NextRandom(&seed) % 14);
+    for (std::size_t j = 0; j < length; ++j) {
+      uint64_t r = NextRandom(&seed) % 26;
+      r = r * r / 26;
+      keys[i].push_back(static_cast<char>('a' + r));
+    }
+  }
+  return keys;
+}
+
+void BenchBuild(const std::vector<std::string>& keys, bool packed, bool parallel) {
+  std::size_t n = keys.size();
+  balgo::DaTrie<char, uint32_t> trie;
+  trie.set_packed(packed);
+  trie.set_parallel(parallel);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  double start = Now();
+  trie.Build();
+  double elapsed = Now() - start;
+  std::cout << "[Build] " << trie.Name() << (packed ? "(packed)" : "")
+      << (parallel ? "(parallel)" : "") << " keys=" << n << ", time=" << elapsed
+      << "s, ns/key=" << elapsed * 1e9 / static_cast<double>(n) << ", "
+      << trie.StatsString() << std::endl;
+}
+
+/// Looks up the keys in random order, one by one and with MatchBatch
+void BenchMatch(const std::vector<std::string>& keys, bool packed) {
+  balgo::DaTrie<char, uint32_t> trie;
+  trie.set_packed(packed);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie.Build();
+  std::vector<const char*> queries(keys.size());
+  std::vector<std::size_t> lengths(keys.size());
+  uint64_t seed = 2463534242ULL;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    std::size_t j = static_cast<std::size_t>(NextRandom(&seed) % keys.size());
+    queries[i] = keys[j].c_str();
+    lengths[i] = keys[j].size();
+  }
+  std::vector<uint32_t> values(keys.size());
+  double start = Now();
+  std::size_t found = 0;
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    found += trie.Match(queries[i], lengths[i], &values[i]);
+  }
+  double single = Now() - start;
+  start = Now();
+  std::size_t batch_found = trie.MatchBatch(&queries[0], &lengths[0], queries.size(), &values[0],
+                                            NULL);
+  double batch = Now() - start;
+  std::cout << "[Match] " << trie.Name() << (packed ? "(packed)" : "") << " keys=" << keys.size()
+      << ", found=" << found << "/" << batch_found << ", Match ns/key="
+      << single * 1e9 / static_cast<double>(keys.size()) << ", MatchBatch ns/key="
+      << batch * 1e9 / static_cast<double>(keys.size()) << std::endl;
+}
+
+/// Builds from the sorted keys with DaTrieBuilder
+void BenchStream(std::vector<std::string> keys) {
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  balgo::DaTrie<char, uint32_t> trie;
+  double start = Now();
+  balgo::DaTrieBuilder<char, uint32_t> builder(&trie);
+  builder.AddKeys(keys.begin(), keys.end());
+  builder.Finish();
+  double elapsed = Now() - start;
+  std::cout << "[Stream] " << trie.Name() << " keys=" << keys.size() << ", time=" << elapsed
+      << "s, ns/key=" << elapsed * 1e9 / static_cast<double>(keys.size()) << ", "
+      << trie.StatsString() << std::endl;
+}
+
+/// Inserts and erases the last keys on a trie built from the others
+void BenchUpdate(const std::vector<std::string>& keys) {
+  std::size_t n = keys.size() - keys.size() / 100;
+  balgo::DaTrie<char, uint32_t> trie;
+  for (std::size_t i = 0; i < n; ++i) {
+    trie.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie.Build();
+  double start = Now();
+  for (std::size_t i = n; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  double inserted = Now();
+  for (std::size_t i = n; i < keys.size(); ++i) {
+    trie.Erase(keys[i].c_str(), keys[i].size());
+  }
+  double erased = Now();
+  std::size_t m = keys.size() - n;
+  std::cout << "[Update] " << trie.Name() << " keys=" << n << ", updates=" << m
+      << ", insert ns/key=" << (inserted - start) * 1e9 / static_cast<double>(m)
+      << ", erase ns/key=" << (erased - inserted) * 1e9 / static_cast<double>(m) << ", "
+      << trie.StatsString() << std::endl;
+}
+
+/// Looks up the keys through the virtual Trie interface and through StaticTrie
+template<typename Impl>
+void BenchDispatch(const std::vector<std::string>& keys, Impl* trie, const std::string& label) {
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie->Build();
+  std::string text;
+  std::vector<std::size_t> offsets(1, 0);
+  uint64_t seed = 2463534242ULL;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    text += keys[static_cast<std::size_t>(NextRandom(&seed) % keys.size())];
+    offsets.push_back(text.size());
+  }
+  const char* data = text.data();
+  const balgo::Trie<char, uint32_t>& base = *trie;
+  balgo::StaticTrie<Impl> view(*trie);
+  std::vector<uint32_t> values;
+  std::size_t found = 0;
+  double start = Now();
+  for (std::size_t i = 1; i < offsets.size(); ++i) {
+    found += base.Match(data + offsets[i - 1], data + offsets[i]);
+    found += base.MatchPrefix(data + offsets[i - 1], data + offsets[i], &values);
+  }
+  double dynamic = Now() - start;
+  start = Now();
+  for (std::size_t i = 1; i < offsets.size(); ++i) {
+    found += view.Match(data + offsets[i - 1], data + offsets[i]);
+    found += view.MatchPrefix(data + offsets[i - 1], data + offsets[i], &values);
+  }
+  double fixed = Now() - start;
+  // each character is walked twice, by Match and by MatchPrefix
+  double chars = 2.0 * static_cast<double>(text.size());
+  std::cout << "[Dispatch] " << trie->Name() << label << " keys=" << keys.size()
+      << ", found=" << found << ", virtual ns/char=" << dynamic * 1e9 / chars
+      << ", static ns/char=" << fixed * 1e9 / chars << std::endl;
+}
+
+balgo::DaTrie<char, uint32_t>* NewTrie(const std::vector<std::string>& keys) {
+  balgo::DaTrie<char, uint32_t>* trie = new balgo::DaTrie<char, uint32_t>;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie->Build();
+  return trie;
+}
+
+/**
+ * Reads a SharedTrie from num_readers threads, one snapshot per lookup, for a
+ * fixed number of lookups each; with swap, another thread keeps rebuilding
+ * and publishing the trie meanwhile.
+ */
+void BenchShared(const std::vector<std::string>& keys, int num_readers, bool swap) {
+  balgo::SharedTrie<balgo::DaTrie<char, uint32_t> > shared(NewTrie(keys));
+  const std::size_t kLookups = 2000000;
+  std::atomic<int> running(num_readers);
+  std::atomic<std::size_t> found(0);
+  double start = Now();
+#pragma omp parallel num_threads(num_readers + 1)
+  {
+    int id = omp_get_thread_num();
+    if (id == num_readers) {
+      while (swap && running > 0) {
+        shared.Publish(NewTrie(keys));
+      }
+    } else {
+      uint64_t seed = 2463534242ULL;
+      seed += static_cast<unsigned>(id);
+      std::size_t local = 0;
+      for (std::size_t i = 0; i < kLookups; ++i) {
+        const std::string& key = keys[static_cast<std::size_t>(NextRandom(&seed) % keys.size())];
+        balgo::SharedTrie<balgo::DaTrie<char, uint32_t> >::Snapshot snapshot(shared);
+        local += snapshot->Match(key.c_str(), key.size());
+      }
+      found += local;
+      --running;
+    }
+  }
+  double elapsed = Now() - start;
+  std::cout << "[Shared] readers=" << num_readers << (swap ? "(swapping)" : "") << " keys="
+      << keys.size() << ", swaps=" << shared.version() - 1 << ", found=" << found
+      << ", lookups/s=" << static_cast<double>(kLookups) * num_readers / elapsed
+      << std::endl;
+}
+
+/// Looks up keys with one random edit within max_edits
+template<typename Impl>
+void BenchFuzzy(const std::vector<std::string>& keys, Impl* trie, std::size_t max_edits) {
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie->Build();
+  const std::size_t kQueries = 1000;
+  std::vector<std::string> queries(kQueries);
+  uint64_t seed = 2463534242ULL;
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    queries[i] = keys[static_cast<std::size_t>(NextRandom(&seed) % keys.size())];
+    std::size_t pos = static_cast<std::size_t>(NextRandom(&seed) % queries[i].size());
+    queries[i][pos] = static_cast<char>('a' + NextRandom(&seed) % 26);
+  }
+  std::vector<typename Impl::FuzzyHit> hits;
+  std::size_t found = 0;
+  double start = Now();
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    found += trie->FuzzyMatch(queries[i].data(), queries[i].size(), max_edits, &hits);
+  }
+  double elapsed = Now() - start;
+  std::cout << "[Fuzzy] " << trie->Name() << " keys=" << keys.size() << ", max_edits="
+      << max_edits << ", hits/query=" << static_cast<double>(found) / kQueries << ", us/query="
+      << elapsed * 1e6 / kQueries << std::endl;
+}
+
+/// Builds a trie backend and looks up every key, with Match and MatchPrefix
+template<typename Impl>
+void BenchBackend(const std::vector<std::string>& keys, Impl* trie) {
+  double start = Now();
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie->Build();
+  trie->ShrinkToFit();
+  double build = Now() - start;
+  balgo::MemoryStats stats = trie->MemoryUsage();
+  std::size_t nodes = trie->NumNodes() - 1;
+  start = Now();
+  std::size_t found = 0;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    found += trie->Match(keys[i].c_str(), keys[i].size());
+  }
+  double match = Now() - start;
+  std::vector<uint32_t> values;
+  std::size_t prefixes = 0;
+  start = Now();
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    prefixes += trie->MatchPrefix(keys[i].c_str(), keys[i].size(), &values);
+  }
+  double prefix = Now() - start;
+  std::cout << "[Backend] " << trie->Name() << " keys=" << keys.size() << ", nodes=" << nodes
+      << ", build=" << build << "s, lookup MB=" << (stats.nodes + stats.extra) / 1e6
+      << ", bytes/key=" << static_cast<double>(stats.nodes + stats.extra)
+      / static_cast<double>(keys.size()) << ", bits/node=" << 8.0
+      * static_cast<double>(stats.nodes + stats.extra) / static_cast<double>(nodes) << ", found=" << found << ", Match ns/key="
+      << match * 1e9 / static_cast<double>(keys.size()) << ", prefixes=" << prefixes
+      << ", MatchPrefix ns/key=" << prefix * 1e9 / static_cast<double>(keys.size())
+      << std::endl;
+}
+
+/// n queries drawn from the keys with Zipf(1) frequencies, the ranks shuffled
+std::vector<const char*> ZipfQueries(const std::vector<std::string>& keys, std::size_t n,
+                                     uint64_t seed) {
+  std::vector<double> cdf(keys.size());
+  double sum = 0;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    sum += 1.0 / static_cast<double>(i + 1);
+    cdf[i] = sum;
+  }
+  std::vector<const char*> queries(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    double r = static_cast<double>(NextRandom(&seed) % (1ULL << 53)) / (1ULL << 53) * sum;
+    std::size_t rank = static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), r)
+                                                - cdf.begin());
+    rank = std::min(rank, keys.size() - 1);
+    // a fixed odd multiplier spreads the hot ranks over the key order
+    queries[i] = keys[(rank * 2654435761ULL) % keys.size()].c_str();
+  }
+  return queries;
+}
+
+/// Looks up Zipf queries before and after a Relayout on a separate sample
+template<typename Impl>
+void BenchRelayout(const std::vector<std::string>& keys, Impl* trie) {
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie->Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+  }
+  trie->Build();
+  std::vector<const char*> sample = ZipfQueries(keys, 100000, 1);
+  std::vector<const char*> queries = ZipfQueries(keys, 2000000, 2);
+  std::vector<std::size_t> lengths(queries.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    lengths[i] = std::strlen(queries[i]);
+  }
+  double times[2];
+  std::size_t found[2] = { 0, 0 };
+  double relayout = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) {
+      double start = Now();
+      trie->Relayout(&sample[0], sample.size());
+      relayout = Now() - start;
+    }
+    double start = Now();
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      found[pass] += trie->Match(queries[i], lengths[i]);
+    }
+    times[pass] = Now() - start;
+  }
+  std::cout << "[Relayout] " << trie->Name() << " keys=" << keys.size() << ", found="
+      << found[0] << "/" << found[1] << ", relayout=" << relayout << "s, Match ns/query="
+      << times[0] * 1e9 / static_cast<double>(queries.size()) << " -> "
+      << times[1] * 1e9 / static_cast<double>(queries.size()) << std::endl;
+}
+
+/// Scores key i by a hash of i, like a query log frequency
+struct HashScore {
+  uint32_t operator()(uint32_t value) const {
+    return static_cast<uint32_t>(value * 2654435761ULL % 1000003);
+  }
+};
+
+/**
+ * Completes short prefixes of the keys to the 10 best scored keys, with
+ * TernaryTrie::TopK and by scanning every completion in a sorted key list
+ */
+void BenchTopK(std::vector<std::string> keys, std::size_t prefix_length) {
+  const std::size_t kQueries = 1000;
+  const std::size_t kTop = 10;
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  balgo::TernaryTrie<char, uint32_t> trie;
+  std::vector<std::pair<std::string, uint32_t> > sorted(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), keys[i].size(), static_cast<uint32_t>(i));
+    sorted[i] = std::make_pair(keys[i], HashScore()(static_cast<uint32_t>(i)));
+  }
+  trie.Build();
+  trie.BuildScores(HashScore());
+  std::vector<std::string> queries(kQueries);
+  uint64_t seed = 2463534242ULL;
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    const std::string& key = keys[static_cast<std::size_t>(NextRandom(&seed) % keys.size())];
+    queries[i] = key.substr(0, prefix_length);
+  }
+
+  std::vector<balgo::TernaryTrie<char, uint32_t>::TopHit> hits;
+  uint64_t top_sum = 0;
+  double start = Now();
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    trie.TopK(queries[i].data(), queries[i].size(), kTop, &hits);
+    top_sum += hits.empty() ? 0 : hits.back().score;
+  }
+  double top = Now() - start;
+
+  std::vector<uint32_t> scores;
+  uint64_t scan_sum = 0;
+  std::size_t completions = 0;
+  start = Now();
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    scores.clear();
+    std::vector<std::pair<std::string, uint32_t> >::const_iterator it = std::lower_bound(
+        sorted.begin(), sorted.end(), std::make_pair(queries[i], 0U));
+    for (; it != sorted.end() && it->first.compare(0, queries[i].size(), queries[i]) == 0; ++it) {
+      scores.push_back(it->second);
+    }
+    completions += scores.size();
+    std::size_t n = std::min(kTop, scores.size());
+    std::partial_sort(scores.begin(), scores.begin() + static_cast<std::ptrdiff_t>(n),
+                      scores.end(), std::greater<uint32_t>());
+    scan_sum += n == 0 ? 0 : scores[n - 1];
+  }
+  double scan = Now() - start;
+  std::cout << "[TopK] " << trie.Name() << " keys=" << keys.size() << ", prefix="
+      << prefix_length << ", completions/query=" << completions / kQueries << ", k=" << kTop
+      << (top_sum == scan_sum ? "" : " MISMATCH") << ", TopK us/query="
+      << top * 1e6 / kQueries << ", scan+sort us/query=" << scan * 1e6 / kQueries << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < argc; ++i) {
+    sizes.push_back(static_cast<std::size_t>(std::atol(argv[i])));
+  }
+  if (sizes.empty()) {
+    sizes.push_back(100000);
+    sizes.push_back(1000000);
+    sizes.push_back(10000000);
+  }
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    std::vector<std::string> keys = GenerateKeys(sizes[i]);
+    BenchBuild(keys, false, false);
+    BenchBuild(keys, true, false);
+    BenchBuild(keys, false, true);
+    BenchStream(keys);
+    BenchMatch(keys, false);
+    BenchMatch(keys, true);
+    BenchUpdate(keys);
+    balgo::DaTrie<char, uint32_t> da;
+    BenchDispatch(keys, &da, "");
+    balgo::DaTrie<char, uint32_t> packed;
+    packed.set_packed(true);
+    BenchDispatch(keys, &packed, "(packed)");
+    balgo::TernaryTrie<char, uint32_t> ternary;
+    BenchDispatch(keys, &ternary, "");
+    BenchShared(keys, 1, false);
+    BenchShared(keys, 4, false);
+    BenchShared(keys, 4, true);
+    balgo::DaTrie<char, uint32_t> backend_da;
+    BenchBackend(keys, &backend_da);
+    balgo::TernaryTrie<char, uint32_t> backend_ternary;
+    BenchBackend(keys, &backend_ternary);
+    balgo::LoudsTrie<char, uint32_t> backend_louds;
+    BenchBackend(keys, &backend_louds);
+    balgo::RadixTrie<char, uint32_t> backend_radix;
+    BenchBackend(keys, &backend_radix);
+    balgo::DaTrie<char, uint32_t> relayout_da;
+    BenchRelayout(keys, &relayout_da);
+    balgo::TernaryTrie<char, uint32_t> relayout_ternary;
+    BenchRelayout(keys, &relayout_ternary);
+    BenchTopK(keys, 1);
+    BenchTopK(keys, 3);
+    for (std::size_t max_edits = 1; max_edits <= 2; ++max_edits) {
+      balgo::DaTrie<char, uint32_t> fuzzy_da;
+      BenchFuzzy(keys, &fuzzy_da, max_edits);
+      balgo::TernaryTrie<char, uint32_t> fuzzy_ternary;
+      BenchFuzzy(keys, &fuzzy_ternary, max_edits);
+    }
+  }
+  return 0;
+}
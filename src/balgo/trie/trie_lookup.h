@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 agent.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @author	agent <agent@local>
+ * @date		2026-10-17
+ */
+
+#ifndef BALGO_TRIE_TRIE_LOOKUP_H_
+#define BALGO_TRIE_TRIE_LOOKUP_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "trie_traits.h"
+
+namespace balgo {
+
+/// The types of the lookups, the same for every trie of Value
+template<typename Value>
+struct TrieLookupTypes {
+  /// A key matched in a text by Segment
+  struct Span {
+    std::size_t start;   ///< Offset of the key in the text
+    std::size_t length;  ///< Length of the key
+    Value value;
+  };
+
+  struct MatchFunc {
+    virtual void operator()(const Value& value, std::size_t offset) {
+    }
+  };
+
+  template<typename Values>
+  struct ValueMatchFunc : public MatchFunc {
+   public:
+    ValueMatchFunc(Values* values)
+        : values_(values) {
+    }
+    virtual void operator()(const Value& value, std::size_t offset) {
+      values_->push_back(value);
+    }
+   private:
+    Values* values_;
+  };
+};
+
+/**
+ * @brief The lookups of a trie, written once over the node primitives of Derived
+ *
+ * Derived provides Root, Child, IsNull, IsFinal and GetValue and befriends
+ * this class. Trie passes itself, so the primitives are dispatched
+ * virtually; StaticTrie forwards them to a concrete trie by qualified name,
+ * so the compiler can inline them into these loops.
+ */
+template<typename Derived, typename Char, typename Value, typename NodePtr>
+class TrieLookup {
+ public:
+  typedef typename TrieLookupTypes<Value>::Span Span;
+  typedef typename TrieLookupTypes<Value>::MatchFunc MatchFunc;
+  template<typename Values>
+  using ValueMatchFunc = typename TrieLookupTypes<Value>::template ValueMatchFunc<Values>;
+
+  bool Match(const Char* begin, const Char* end, Value* value = NULL) const {
+    NodePtr p = Self().Root();
+    for ( ; begin != end; ++begin) {
+      NodePtr child = Self().Child(p, *begin);
+      if (Self().IsNull(child)) return false;
+      p = child;
+    }
+    if (!Self().IsFinal(p)) {
+      return false;
+    }
+    if (value) {
+      *value = *Self().GetValue(p);
+    }
+    return true;
+  }
+
+  bool Match(const Char* begin, std::size_t length, Value* value = NULL) const {
+    return Match(begin, begin + length, value);
+  }
+
+  bool Match(const Char* begin, Value* value = NULL) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return Match(begin, begin + length, value);
+  }
+
+  /**
+   * Calls visit(value, offset) for each key that is a prefix of [begin, end),
+   * where offset is that of its last character. visit is any callable
+   * returning bool and is inlined into the walk; it returns false to stop.
+   * @return the number of keys visited
+   */
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  MatchPrefix(const Char* begin, const Char* end, Visitor&& visit) const {
+    std::size_t cnt = 0;
+    NodePtr p = Self().Root();
+    for (std::size_t offset = 0; begin != end; ++begin, ++offset) {
+      NodePtr child = Self().Child(p, *begin);
+      if (Self().IsNull(child)) break;
+      p = child;
+      if (Self().IsFinal(p)) {
+        ++cnt;
+        if (!visit(*Self().GetValue(p), offset)) break;
+      }
+    }
+    return cnt;
+  }
+
+  template<typename Visitor>
+  typename EnableIfVisitor<Visitor, MatchFunc, std::size_t>::type
+  MatchPrefix(const Char* begin, std::size_t length, Visitor&& visit) const {
+    return MatchPrefix(begin, begin + length, visit);
+  }
+
+  std::size_t MatchPrefix(const Char* begin, const Char* end, MatchFunc& func) const {
+    return MatchPrefix(begin, end, FuncVisitor(func));
+  }
+
+  template<typename Values>
+  std::size_t MatchPrefix(const Char* begin, const Char* end, Values* values, bool clear = true) const {
+    if (values && clear) values->clear();
+    if (values) {
+      return MatchPrefix(begin, end, PushBackVisitor<Values>(values));
+    } else {
+      return MatchPrefix(begin, end, CountVisitor());
+    }
+  }
+
+  template<typename Values>
+  std::size_t MatchPrefix(const Char* begin, std::size_t length, Values* values, bool clear = true) const {
+    return MatchPrefix(begin, begin + length, values, clear);
+  }
+
+  template<typename Values>
+  std::size_t MatchPrefix(const Char* begin, Values* values, bool clear = true) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return MatchPrefix(begin, begin + length, values, clear);
+  }
+
+  std::size_t MatchPrefix(const Char* begin, const Char* end) const {
+    return MatchPrefix<DefaultValues>(begin, end, NULL, false);
+  }
+
+  std::size_t MatchPrefix(const Char* begin, std::size_t length) const {
+    return MatchPrefix<DefaultValues>(begin, begin + length, NULL, false);
+  }
+
+  std::size_t MatchPrefix(const Char* begin) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return MatchPrefix<DefaultValues>(begin, begin + length, NULL, false);
+  }
+
+  /**
+   * Finds the longest key that is a prefix of [begin, end) in one walk.
+   * @return its length, or 0 if no key is a prefix; *value gets its value
+   */
+  std::size_t LongestPrefix(const Char* begin, const Char* end, Value* value = NULL) const {
+    std::size_t length = 0;
+    const Value* found = NULL;
+    NodePtr p = Self().Root();
+    for (const Char* it = begin; it != end; ) {
+      p = Self().Child(p, *it++);
+      if (Self().IsNull(p)) break;
+      if (Self().IsFinal(p)) {
+        length = static_cast<std::size_t>(it - begin);
+        found = Self().GetValue(p);
+      }
+    }
+    if (found && value) {
+      *value = *found;
+    }
+    return length;
+  }
+
+  std::size_t LongestPrefix(const Char* begin, std::size_t length, Value* value = NULL) const {
+    return LongestPrefix(begin, begin + length, value);
+  }
+
+  std::size_t LongestPrefix(const Char* begin, Value* value = NULL) const {
+    std::size_t length = std::char_traits<Char>::length(begin);
+    return LongestPrefix(begin, begin + length, value);
+  }
+
+  /**
+   * Segments [begin, end) by maximum forward matching: the longest key
+   * starting at the current position becomes a span and the scan resumes
+   * after it, while a position where no key starts is skipped. Spans are
+   * written to spans[0, capacity) with no allocation; once it is full, the
+   * scan may be resumed from the end of the last span.
+   * @return the number of spans written
+   */
+  std::size_t Segment(const Char* begin, const Char* end, Span* spans,
+                      std::size_t capacity) const {
+    std::size_t cnt = 0;
+    for (const Char* it = begin; it != end && cnt < capacity; ) {
+      std::size_t length = LongestPrefix(it, end, &spans[cnt].value);
+      if (length) {
+        spans[cnt].start = static_cast<std::size_t>(it - begin);
+        spans[cnt].length = length;
+        ++cnt;
+        it += length;
+      } else {
+        ++it;
+      }
+    }
+    return cnt;
+  }
+
+  std::size_t Segment(const Char* begin, std::size_t length, Span* spans,
+                      std::size_t capacity) const {
+    return Segment(begin, begin + length, spans, capacity);
+  }
+
+ protected:
+  /// Adapts a MatchFunc to a visitor that never stops
+  class FuncVisitor {
+   public:
+    explicit FuncVisitor(MatchFunc& func) : func_(func) { }
+    bool operator()(const Value& value, std::size_t offset) const {
+      func_(value, offset);
+      return true;
+    }
+   private:
+    MatchFunc& func_;
+  };
+
+  template<typename Values>
+  class PushBackVisitor {
+   public:
+    explicit PushBackVisitor(Values* values) : values_(values) { }
+    bool operator()(const Value& value, std::size_t /*offset*/) const {
+      values_->push_back(value);
+      return true;
+    }
+   private:
+    Values* values_;
+  };
+
+  struct CountVisitor {
+    bool operator()(const Value& /*value*/, std::size_t /*offset*/) const {
+      return true;
+    }
+  };
+
+ private:
+  typedef std::vector<Value> DefaultValues;
+
+  const Derived& Self() const {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+}  // namespace balgo
+#endif  // BALGO_TRIE_TRIE_LOOKUP_H_
@@ -41,6 +41,7 @@ void Demo(balgo::Trie<char, size_t>& trie) {
 
   std::cout << "Using " << trie.Name() << std::endl;
   std::cout << "StatsString: " << trie.StatsString() << std::endl;
+  std::cout << "MemoryUsage: " << trie.MemoryUsage().ToString() << std::endl;
 
   for (size_t i = 0; i < n; ++i) {
     size_t value;
@@ -26,9 +26,14 @@
 #ifndef BALGO_TRIE_TRIE_TEST_COMMON_H_
 #define BALGO_TRIE_TRIE_TEST_COMMON_H_
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
 #include <vector>
 #include <gtest/gtest.h>
 
+#include "static_trie.h"
 #include "trie.h"
 
 #define ARRAY_SIZE(arr) sizeof(arr) / sizeof(arr[0])
@@ -94,5 +99,382 @@ void TestMatchPrefix(Trie<char, size_t>& trie) {
   EXPECT_EQ(expected, values);
 }
 
+/// Collects the matches passed to it, up to a limit
+struct CollectVisitor {
+  explicit CollectVisitor(size_t l) : limit(l) { }
+  bool operator()(const size_t& value, size_t offset) {
+    values.push_back(value);
+    offsets.push_back(offset);
+    return values.size() < limit;
+  }
+  size_t limit;
+  std::vector<size_t> values;
+  std::vector<size_t> offsets;
+};
+
+void TestMatchPrefixVisitor(Trie<char, size_t>& trie) {
+  const char * kPatterns[] = { "a", "bca", "abc", "abcde" };
+  trie.Clear();
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    trie.Insert(kPatterns[i], i);
+  }
+  trie.Build();
+
+  std::string text = "abcdefgh";
+  CollectVisitor all(100);
+  ASSERT_EQ(3U, trie.MatchPrefix(text.data(), text.data() + text.size(), all));
+  size_t values[] = { 0, 2, 3 };
+  size_t offsets[] = { 0, 2, 4 };
+  EXPECT_EQ(std::vector<size_t>(values, values + 3), all.values);
+  EXPECT_EQ(std::vector<size_t>(offsets, offsets + 3), all.offsets);
+
+  CollectVisitor two(2);
+  EXPECT_EQ(2U, trie.MatchPrefix(text.data(), text.size(), two));
+  EXPECT_EQ(std::vector<size_t>(values, values + 2), two.values);
+  EXPECT_EQ(1U, trie.MatchPrefix(text.data(), text.size(), CollectVisitor(1)));
+  EXPECT_EQ(0U, trie.MatchPrefix(text.data(), text.data(), CollectVisitor(1)));
+}
+
+void TestSegment(Trie<char, size_t>& trie) {
+  const char * kPatterns[] = { "a", "ab", "abc", "bcd", "cd", "de" };
+  trie.Clear();
+  for (size_t i = 0; i < ARRAY_SIZE(kPatterns); ++i) {
+    trie.Insert(kPatterns[i], i);
+  }
+  trie.Build();
+
+  size_t value = 9999;
+  EXPECT_EQ(0U, trie.LongestPrefix("", &value));
+  EXPECT_EQ(0U, trie.LongestPrefix("xab", &value));
+  EXPECT_EQ(9999U, value);
+  EXPECT_EQ(2U, trie.LongestPrefix("abd", &value));
+  EXPECT_EQ(1U, value);
+  EXPECT_EQ(3U, trie.LongestPrefix("abcdef", &value));
+  EXPECT_EQ(2U, value);
+  EXPECT_EQ(1U, trie.LongestPrefix("ab", 1));
+
+  // abc|x|de|cd|b|ab
+  std::string text = "abcxdecdbab";
+  Trie<char, size_t>::Span spans[8];
+  ASSERT_EQ(4U, trie.Segment(text.data(), text.size(), spans, 8));
+  const size_t kExpected[][3] = { { 0, 3, 2 }, { 4, 2, 5 }, { 6, 2, 4 }, { 9, 2, 1 } };
+  for (size_t i = 0; i < ARRAY_SIZE(kExpected); ++i) {
+    EXPECT_EQ(kExpected[i][0], spans[i].start) << " span: " << i;
+    EXPECT_EQ(kExpected[i][1], spans[i].length) << " span: " << i;
+    EXPECT_EQ(kExpected[i][2], spans[i].value) << " span: " << i;
+  }
+  EXPECT_EQ(2U, trie.Segment(text.data(), text.size(), spans, 2));
+  EXPECT_EQ(4U, spans[1].start);
+  EXPECT_EQ(0U, trie.Segment(text.data(), text.size(), spans, 0));
+  EXPECT_EQ(0U, trie.Segment("xyz", 3, spans, 8));
+}
+
+/**
+ * Generates n pseudo-random keys over a small alphabet, so that keys share
+ * many prefixes and nodes have widely varying fan-outs.
+ */
+std::vector<std::string> GenerateKeys(size_t n, uint32_t seed = 1) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < n; ++i) {
+    std::string key;
+    seed = seed * 1103515245 + 12345;
+    size_t length = 1 + (seed >> 16) % 12;
+    for (size_t j = 0; j < length; ++j) {
+      seed = seed * 1103515245 + 12345;
+      key.push_back(static_cast<char>('a' + (seed >> 16) % (j < 2 ? 26 : 4)));
+    }
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+void TestManyKeys(Trie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t value = 9999;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    EXPECT_EQ(keys[i], keys[value]);
+  }
+  std::vector<std::string> others = GenerateKeys(20000, 2);
+  std::sort(keys.begin(), keys.end());
+  for (size_t i = 0; i < others.size(); ++i) {
+    bool expected = std::binary_search(keys.begin(), keys.end(), others[i]);
+    EXPECT_EQ(expected, trie.Match(others[i].c_str())) << " key: " << others[i];
+  }
+}
+
+/// Lookups give the same results after a Relayout on a skewed sample
+template<typename Impl>
+void TestRelayout(Impl& trie) {
+  std::vector<std::string> keys = GenerateKeys(5000);
+  std::vector<std::string> others = GenerateKeys(1000, 2);
+  trie.Clear();
+  EXPECT_FALSE(trie.Relayout(NULL, 0));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  others.insert(others.end(), keys.begin(), keys.end());
+  std::vector<std::pair<bool, size_t> > matches(others.size());
+  std::vector<std::vector<size_t> > prefixes(others.size());
+  for (size_t i = 0; i < others.size(); ++i) {
+    matches[i].first = trie.Match(others[i].c_str(), &matches[i].second);
+    trie.MatchPrefix(others[i].c_str(), &prefixes[i]);
+  }
+
+  // a few keys make up most of the sample
+  std::vector<const char*> sample;
+  for (size_t i = 0; i < 2000; ++i) {
+    sample.push_back(keys[i % (i < 1500 ? 20 : keys.size())].c_str());
+  }
+  sample.push_back("");
+  sample.push_back("zzzzzzzzzzzzzzzzzzzz");
+  ASSERT_TRUE(trie.Relayout(&sample[0], sample.size()));
+  for (size_t i = 0; i < others.size(); ++i) {
+    size_t value = 0;
+    ASSERT_EQ(matches[i].first, trie.Match(others[i].c_str(), &value)) << " key: " << others[i];
+    if (matches[i].first) {
+      EXPECT_EQ(matches[i].second, value) << " key: " << others[i];
+    }
+    std::vector<size_t> values;
+    trie.MatchPrefix(others[i].c_str(), &values);
+    EXPECT_EQ(prefixes[i], values) << " key: " << others[i];
+  }
+  ASSERT_TRUE(trie.Relayout(&sample[0], 0));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.Match(keys[i].c_str())) << " key: " << keys[i];
+  }
+}
+
+/// Checks that StaticTrie answers like the virtual lookups of the trie
+template<typename Impl>
+void TestStaticTrie(Impl& trie) {
+  std::vector<std::string> keys = GenerateKeys(5000);
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  const Trie<char, size_t>& base = trie;
+  StaticTrie<Impl> view(trie);
+
+  std::vector<std::string> queries = GenerateKeys(5000, 2);
+  queries.insert(queries.end(), keys.begin(), keys.end());
+  std::vector<size_t> expected;
+  std::vector<size_t> actual;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const std::string& query = queries[i];
+    size_t expected_value = 9999;
+    size_t value = 9999;
+    ASSERT_EQ(base.Match(query.c_str(), &expected_value), view.Match(query.c_str(), &value))
+        << " key: " << query;
+    EXPECT_EQ(expected_value, value);
+    EXPECT_EQ(base.MatchPrefix(query.c_str(), &expected),
+              view.MatchPrefix(query.c_str(), &actual)) << " key: " << query;
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(base.LongestPrefix(query.c_str(), &expected_value),
+              view.LongestPrefix(query.c_str(), &value)) << " key: " << query;
+    EXPECT_EQ(expected_value, value);
+  }
+
+  CollectVisitor expected_visitor(2);
+  CollectVisitor visitor(2);
+  for (size_t i = 0; i < 100; ++i) {
+    const std::string& query = queries[i];
+    EXPECT_EQ(base.MatchPrefix(query.data(), query.size(), expected_visitor),
+              view.MatchPrefix(query.data(), query.size(), visitor));
+  }
+  EXPECT_EQ(expected_visitor.values, visitor.values);
+  EXPECT_EQ(expected_visitor.offsets, visitor.offsets);
+
+  std::string text;
+  for (size_t i = 0; i < 200; ++i) {
+    text += queries[i * 7];
+  }
+  std::vector<typename Impl::Span> expected_spans(text.size());
+  std::vector<typename Impl::Span> spans(text.size());
+  size_t cnt = base.Segment(text.data(), text.size(), &expected_spans[0], text.size());
+  ASSERT_EQ(cnt, view.Segment(text.data(), text.size(), &spans[0], spans.size()));
+  for (size_t i = 0; i < cnt; ++i) {
+    EXPECT_EQ(expected_spans[i].start, spans[i].start);
+    EXPECT_EQ(expected_spans[i].length, spans[i].length);
+    EXPECT_EQ(expected_spans[i].value, spans[i].value);
+  }
+}
+
+size_t EditDistance(const std::string& a, const std::string& b) {
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) {
+    row[j] = j;
+  }
+  for (size_t i = 1; i <= a.size(); ++i) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      size_t cost = std::min(diagonal + (a[i - 1] != b[j - 1]), std::min(row[j], row[j - 1]) + 1);
+      diagonal = row[j];
+      row[j] = cost;
+    }
+  }
+  return row[b.size()];
+}
+
+/// Whether lhs is before rhs in the order of signed chars
+bool SignedLess(const std::string& lhs, const std::string& rhs) {
+  return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                      std::less<char>());
+}
+
+/// Checks FuzzyMatch against the edit distance to every key, in the label order of the trie
+void TestFuzzyMatch(Trie<char, size_t>& trie, bool signed_labels = false) {
+  typedef Trie<char, size_t>::FuzzyHit FuzzyHit;
+  std::vector<FuzzyHit> hits;
+  trie.Clear();
+  trie.Build();
+  EXPECT_EQ(0U, trie.FuzzyMatch("abc", 2, &hits));
+
+  std::vector<std::string> keys = GenerateKeys(1500);
+  // the pruned labels of "a" for "b\xe9" are listed in the order of the trie
+  keys.push_back("a\xe9");
+  keys.push_back("ab\xe9");
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  std::vector<std::string> sorted(keys);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  if (signed_labels) {
+    std::sort(sorted.begin(), sorted.end(), SignedLess);
+  }
+
+  std::vector<std::string> queries = GenerateKeys(100, 2);
+  queries.insert(queries.end(), keys.begin(), keys.begin() + 100);
+  queries.push_back("");
+  queries.push_back("b\xe9");
+  for (size_t max_edits = 0; max_edits <= 2; ++max_edits) {
+    for (size_t i = 0; i < queries.size(); ++i) {
+      const std::string& query = queries[i];
+      std::vector<std::pair<std::string, size_t> > expected;
+      for (size_t j = 0; j < sorted.size(); ++j) {
+        size_t distance = EditDistance(query, sorted[j]);
+        if (distance <= max_edits) {
+          expected.push_back(std::make_pair(sorted[j], distance));
+        }
+      }
+      size_t cnt = trie.FuzzyMatch(query.data(), query.size(), max_edits, &hits);
+      ASSERT_EQ(expected.size(), cnt) << " query: " << query << ", max_edits: " << max_edits;
+      ASSERT_EQ(cnt, hits.size());
+      for (size_t j = 0; j < cnt; ++j) {
+        EXPECT_EQ(expected[j].first, keys[hits[j].value]) << " query: " << query;
+        EXPECT_EQ(expected[j].second, hits[j].distance) << " query: " << query;
+      }
+    }
+  }
+  size_t size = hits.size();
+  EXPECT_EQ(1U, trie.FuzzyMatch(keys[0].c_str(), 0, &hits, false));
+  EXPECT_EQ(size + 1, hits.size());
+}
+
+void ExpectKeys(const Trie<char, size_t>& trie, const std::vector<std::string>& keys,
+                const std::map<std::string, size_t>& expected) {
+  for (size_t i = 0; i < keys.size(); ++i) {
+    std::map<std::string, size_t>::const_iterator it = expected.find(keys[i]);
+    size_t value = 9999;
+    ASSERT_EQ(it != expected.end(), trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    if (it != expected.end()) {
+      EXPECT_EQ(it->second, value) << " key: " << keys[i];
+    }
+  }
+}
+
+void TestMemoryUsage(Trie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  trie.Clear();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  MemoryStats stats = trie.MemoryUsage();
+  EXPECT_EQ(trie.NodeSize() * trie.NumNodes(), stats.nodes);
+  EXPECT_EQ(keys.size() * sizeof(size_t), stats.values);
+  EXPECT_GE(stats.build, keys.size() / 2 * sizeof(uint32_t));  // key ids
+  EXPECT_GE(stats.peak, stats.nodes + stats.values + stats.build);
+  EXPECT_GT(stats.fill_ratio, 0.5);
+  EXPECT_LE(stats.fill_ratio, 1);
+  EXPECT_EQ(0U, stats.mapped);
+
+  trie.ShrinkToFit();
+  MemoryStats shrunk = trie.MemoryUsage();
+  EXPECT_EQ(stats.nodes, shrunk.nodes);
+  EXPECT_EQ(0U, shrunk.build);
+  EXPECT_EQ(0U, shrunk.slack);
+  EXPECT_EQ(shrunk.nodes + shrunk.values + shrunk.extra, shrunk.Total());
+  EXPECT_EQ(stats.peak, shrunk.peak);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.Match(keys[i].c_str())) << " key: " << keys[i];
+  }
+}
+
+/**
+ * Inserts and erases keys on a trie built from half of them, checking it
+ * against a std::map after each round.
+ */
+void TestUpdates(Trie<char, size_t>& trie) {
+  std::vector<std::string> keys = GenerateKeys(20000);
+  std::vector<std::string> others = GenerateKeys(20000, 2);
+  std::map<std::string, size_t> expected;
+  trie.Clear();
+  for (size_t i = 0; i < keys.size() / 2; ++i) {
+    trie.Insert(keys[i].c_str(), i);
+  }
+  trie.Build();
+  for (size_t i = 0; i < keys.size() / 2; ++i) {
+    size_t value = 9999;
+    ASSERT_TRUE(trie.Match(keys[i].c_str(), &value)) << " key: " << keys[i];
+    expected[keys[i]] = value;
+  }
+
+  for (size_t i = keys.size() / 2; i < keys.size(); ++i) {
+    ASSERT_TRUE(trie.Insert(keys[i].c_str(), i));
+    expected[keys[i]] = i;
+  }
+  ExpectKeys(trie, keys, expected);
+  ExpectKeys(trie, others, expected);
+
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    bool found = expected.erase(keys[i]) > 0;
+    EXPECT_EQ(found, trie.Erase(keys[i].c_str())) << " key: " << keys[i];
+  }
+  EXPECT_FALSE(trie.Erase(""));
+  ExpectKeys(trie, keys, expected);
+  EXPECT_EQ(expected.count("abc") ? 1U : 0U, trie.MatchPrefix("abc") - trie.MatchPrefix("ab"));
+
+  for (size_t i = 0; i < others.size(); i += 2) {
+    ASSERT_TRUE(trie.Insert(others[i].c_str(), i));
+    expected[others[i]] = i;
+  }
+  ExpectKeys(trie, keys, expected);
+  ExpectKeys(trie, others, expected);
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    trie.Erase(keys[i].c_str());
+    trie.Erase(others[i].c_str());
+  }
+  expected.clear();
+  ExpectKeys(trie, keys, expected);
+  EXPECT_EQ(0U, trie.MatchPrefix("abcdefgh"));
+  EXPECT_TRUE(trie.Insert("abc", 1));
+  EXPECT_TRUE(trie.Match("abc"));
+  EXPECT_FALSE(trie.Match("ab"));
+}
+
 }  // namespace balgo
 #endif  // BALGO_TRIE_TRIE_TEST_COMMON_H_
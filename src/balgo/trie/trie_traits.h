@@ -27,6 +27,7 @@
 #define BALGO_TRIE_TRIE_TRAITS_H_
 
 #include <stdint.h>
+#include <type_traits>
 
 namespace balgo {
 
@@ -63,5 +64,17 @@ struct TrieTraits {
   typedef typename UIntTraits<sizeof(Char)>::UInt UChar;
 };
 
+/**
+ * @brief Yields Type for a visitor, i.e. any callable but a pointer or a
+ * functor derived from the virtual Func interface, which have overloads of
+ * their own
+ */
+template<typename Visitor, typename Func, typename Type>
+struct EnableIfVisitor
+    : std::enable_if<!std::is_pointer<typename std::decay<Visitor>::type>::value
+                     && !std::is_base_of<Func, typename std::decay<Visitor>::type>::value,
+                     Type> {
+};
+
 }  // namespace balgo
 #endif  // BALGO_TRIE_TRIE_TRAITS_H_